@@ -0,0 +1,27 @@
+# Writes every file of SHADER_DIR into OUTPUT as a null terminated byte array, listed in the
+# table ShaderSources looks them up in by file name.
+# Usage: cmake -DSHADER_DIR=<dir> -DOUTPUT=<file> -P EmbedShaders.cmake
+
+file(GLOB SHADERS RELATIVE "${SHADER_DIR}" "${SHADER_DIR}/*")
+list(SORT SHADERS)
+
+set(ARRAYS "")
+set(ENTRIES "")
+set(INDEX 0)
+foreach(SHADER ${SHADERS})
+	file(READ "${SHADER_DIR}/${SHADER}" HEX HEX)
+	string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," BYTES "${HEX}")
+	string(APPEND ARRAYS "static const unsigned char shader${INDEX}[] = {${BYTES}0x00};\n")
+	string(APPEND ENTRIES "\t{\"${SHADER}\", shader${INDEX}, sizeof(shader${INDEX}) - 1},\n")
+	math(EXPR INDEX "${INDEX} + 1")
+endforeach()
+
+set(CONTENTS "// Generated by cmake/EmbedShaders.cmake from src/shaders, do not edit\n#include <ShaderSources.h>\n\n${ARRAYS}\nconst ShaderSources::File ShaderSources::files[] = {\n${ENTRIES}};\n\nconst int ShaderSources::fileCount = ${INDEX};\n")
+
+# Leaves the file alone when nothing changed, so it isn't recompiled
+if(EXISTS "${OUTPUT}")
+	file(READ "${OUTPUT}" PREVIOUS)
+endif()
+if(NOT CONTENTS STREQUAL PREVIOUS)
+	file(WRITE "${OUTPUT}" "${CONTENTS}")
+endif()
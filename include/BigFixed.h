@@ -0,0 +1,53 @@
+#ifndef BIGFIXED
+#define BIGFIXED
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Arbitrary precision signed fixed-point number with a 32 bit integer part.
+// Used for view coordinates and reference orbits past what a double can resolve.
+class BigFixed
+{
+private:
+	// Little-endian 32 bit limbs of the magnitude, the last limb is the integer part
+	std::vector<uint32_t> limbs;
+	bool negative = false;
+	int fractionLimbs() const;
+	bool isZero() const;
+	int compareMagnitude(const BigFixed& other) const;
+	void addMagnitude(const BigFixed& other);
+	void subtractMagnitude(const BigFixed& other);
+	uint32_t multiplySmall(uint32_t factor);
+	void divideSmall(uint32_t divisor);
+public:
+	BigFixed(double value = 0.0, int fractionBits = 64);
+	// Parses decimal notation such as "-0.743643887037158704752191506114774" or "1.5e-20"
+	static bool fromString(const std::string& text, int fractionBits, BigFixed& result);
+	// Fraction bits needed to address individual pixels at the given zoom
+	static int bitsForZoom(double zoom);
+
+	int getFractionBits() const;
+	// Truncates when reducing, extends with zeros when growing
+	void setFractionBits(int bits);
+	void ensureFractionBits(int bits);
+
+	double toDouble() const;
+	std::string toString(int digits) const;
+
+	BigFixed operator-() const;
+	BigFixed operator+(const BigFixed& other) const;
+	BigFixed operator-(const BigFixed& other) const;
+	BigFixed operator*(const BigFixed& other) const;
+	BigFixed& operator+=(const BigFixed& other);
+	BigFixed& operator-=(const BigFixed& other);
+	// Doubles are converted at this number's precision
+	BigFixed operator+(double other) const;
+	BigFixed operator-(double other) const;
+	BigFixed& operator+=(double other);
+	BigFixed& operator-=(double other);
+	bool operator==(const BigFixed& other) const;
+	bool operator!=(const BigFixed& other) const;
+};
+
+#endif
\ No newline at end of file
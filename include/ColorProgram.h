@@ -0,0 +1,39 @@
+#ifndef COLORPROGRAM
+#define COLORPROGRAM
+
+#include <Shader.h>
+
+#include <cstdint>
+#include <string>
+
+// Compile-time options of color.frag
+struct ColorVariant
+{
+	bool smoothColoring = false;
+	bool showPeriods = false;
+
+	uint32_t getKey() const
+	{
+		return static_cast<uint32_t>(smoothColoring) | static_cast<uint32_t>(showPeriods) << 1;
+	}
+
+	std::string getDefines() const
+	{
+		std::string defines;
+		if (smoothColoring) defines += "#define SMOOTH_COLORING\n";
+		if (showPeriods) defines += "#define SHOW_PERIODS\n";
+		return defines;
+	}
+};
+
+// color.frag compiled for one ColorVariant, the coloring parameters come from the
+// ColorParameters block
+struct ColorProgram
+{
+	Shader shader;
+	Uniform<int> step;
+
+	explicit ColorProgram(const ColorVariant& variant);
+};
+
+#endif
\ No newline at end of file
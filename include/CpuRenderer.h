@@ -0,0 +1,68 @@
+#ifndef CPURENDERER
+#define CPURENDERER
+
+#include <EscapeKernels.h>
+#include <FractalParams.h>
+#include <ReferenceOrbit.h>
+#include <SeriesApproximation.h>
+#include <ThreadPool.h>
+
+#include <cstdint>
+#include <vector>
+
+// Software implementation of shader.frag, renders into a top-down RGBA8 buffer
+class CpuRenderer
+{
+private:
+	ThreadPool pool;
+	int tileSize;
+	const EscapeKernels* kernels;
+	bool singlePrecision = false;
+	bool perturbation = false;
+	bool seriesApproximation = true;
+	bool subdivision = false;
+	ReferenceOrbit referenceOrbit;
+	SeriesApproximation series;
+	// Per pixel iteration count shared by all of its samples, -1 if they differ
+	std::vector<int> sampleKeys;
+	// The last renderZoom frame, with the real part of each column and the imaginary part of
+	// each row it was rendered at
+	FractalParams zoomParams;
+	std::vector<double> zoomColumns, zoomRows;
+	std::vector<uint8_t> zoomFrame;
+	// Set while renderPixels takes the pixel centers from zoomColumns and zoomRows
+	bool onZoomGrid = false;
+	// Pixels are indices into the image, iterated as one batch
+	template<typename T>
+	void renderPixels(const FractalParams& params, const std::vector<size_t>& pixels, uint8_t* rgba, int* keys) const;
+	void renderPixelsPerturbation(const FractalParams& params, const std::vector<size_t>& pixels, uint8_t* rgba, int* keys) const;
+	void renderPixelList(const FractalParams& params, bool deep, const std::vector<size_t>& pixels, uint8_t* rgba, int* keys) const;
+	static void addRow(std::vector<size_t>& pixels, int w, int y, int x0, int x1);
+	static void addColumn(std::vector<size_t>& pixels, int w, int x, int y0, int y1);
+	void subdivide(const FractalParams& params, bool deep, int x0, int y0, int x1, int y1, uint8_t* rgba, int* keys);
+public:
+	explicit CpuRenderer(unsigned int threadCount = 0, int tileSize = 64);
+	void render(const FractalParams& params, std::vector<uint8_t>& rgba);
+	// XaoS style zooming: renders like render, but rows and columns of the previous renderZoom
+	// frame that lie within half a pixel of new ones are reused, only the others are iterated.
+	// Lines keep the coordinate they were rendered at, so the error never grows past that.
+	// Falls back to render for perturbation and when anything but the view changed.
+	// Returns the fraction of the pixels that were iterated.
+	double renderZoom(const FractalParams& params, std::vector<uint8_t>& rgba);
+	unsigned int getThreadCount() const;
+
+	void setKernels(const EscapeKernels& escapeKernels);
+	const EscapeKernels& getKernels() const;
+	// Float kernels match the shader's precision and run twice the lanes, but break up past ~1e4 zoom
+	void setSinglePrecision(bool enabled);
+	// Perturbation is always used past the zoom where doubles stop resolving pixels
+	void setPerturbation(bool enabled);
+	static bool needsPerturbation(const FractalParams& params);
+	// Skips the iterations shared by the whole view in deep zooms
+	void setSeriesApproximation(bool enabled);
+	int getSkippedIterations() const;
+	// Mariani-Silver: rectangles whose border shares one iteration count are filled without iterating the inside
+	void setSubdivision(bool enabled);
+};
+
+#endif
\ No newline at end of file
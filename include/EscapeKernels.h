@@ -0,0 +1,69 @@
+#ifndef ESCAPEKERNELS
+#define ESCAPEKERNELS
+
+#include <string>
+
+enum class SimdIsa
+{
+	Scalar,
+	SSE2,
+	AVX2,
+	AVX512
+};
+
+// A run of points iterated with z = z^2 + c from z0 until |z| >= 2 or maxIterations is reached.
+// Mandelbrot passes z0 = 0 and c = pixel, Julia passes z0 = pixel and a constant c.
+template<typename T>
+struct EscapeBatch
+{
+	const T* zr;
+	const T* zi;
+	const T* cr;
+	const T* ci;
+	int count;
+	int maxIterations;
+	int* iterations;
+	// Only valid when every z0 is 0, points in the main cardioid or period-2 bulb
+	// then get maxIterations without being iterated
+	bool rejectInterior = false;
+	// Brent cycle detection: z is saved after 1, 2, 4, 8... iterations and a point whose
+	// orbit comes back within this distance of the saved z is interior and gets maxIterations.
+	// 0 disables it. When periods isn't null the cycle length, or 0, is written there.
+	double periodTolerance = 0.0;
+	int* periods = nullptr;
+};
+
+// Closed form membership of the main cardioid and the period-2 bulb, whose points never escape.
+// Returns the period of the component c is in, 1 or 2, or 0 if it's in neither. Static, as the
+// kernels built with AVX flags instantiate it too and their copy mustn't replace the scalar one.
+template<typename T>
+static inline int mainComponentPeriod(T cr, T ci)
+{
+	T x = cr - T(0.25);
+	T ci2 = ci * ci;
+	T q = x * x + ci2;
+	if (q * (q + x) < T(0.25) * ci2) return 1;
+	T xb = cr + T(1);
+	return xb * xb + ci2 < T(0.0625) ? 2 : 0;
+}
+
+// Every kernel returns the same iteration counts as the scalar one, which is the
+// compMul/compAdd loop of shader.frag evaluated in the kernel's precision
+struct EscapeKernels
+{
+	SimdIsa isa;
+	const char* name;
+	void (*iterateDouble)(const EscapeBatch<double>& batch);
+	void (*iterateFloat)(const EscapeBatch<float>& batch);
+};
+
+// Best instruction set supported by both the build and the running CPU
+SimdIsa detectSimdIsa();
+bool isSimdIsaSupported(SimdIsa isa);
+bool parseSimdIsa(const std::string& name, SimdIsa& isa);
+
+// Falls back to the best supported kernel when the requested one is unavailable
+const EscapeKernels& getEscapeKernels(SimdIsa isa);
+const EscapeKernels& getEscapeKernels();
+
+#endif
\ No newline at end of file
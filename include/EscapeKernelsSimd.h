@@ -0,0 +1,257 @@
+#ifndef ESCAPEKERNELSSIMD
+#define ESCAPEKERNELSSIMD
+
+// Shared body of the vectorized escape-time kernels. Only included by the
+// EscapeKernels<ISA>.cpp files, which are compiled with their own instruction
+// set flags, so nothing in here may have external linkage.
+
+#include <EscapeKernels.h>
+
+#include <utility>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define FRACTALDIVE_X86 1
+#endif
+
+void iterateDoubleSSE2(const EscapeBatch<double>& batch);
+void iterateFloatSSE2(const EscapeBatch<float>& batch);
+void iterateDoubleAVX2(const EscapeBatch<double>& batch);
+void iterateFloatAVX2(const EscapeBatch<float>& batch);
+void iterateDoubleAVX512(const EscapeBatch<double>& batch);
+void iterateFloatAVX512(const EscapeBatch<float>& batch);
+
+namespace
+{
+	inline int countBits(unsigned bits)
+	{
+		int n = 0;
+		for (; bits != 0; bits &= bits - 1) n++;
+		return n;
+	}
+
+	// std::min would be a weak symbol shared with the other instruction sets' files
+	inline int minimum(int a, int b)
+	{
+		return a < b ? a : b;
+	}
+
+	// Index of an unrolled vector, std::integral_constant would bring a shared conversion operator
+	template<int I>
+	struct Constant
+	{
+		constexpr operator int() const { return I; }
+	};
+
+	template<typename F, int... I>
+	inline void unrolled(F&& f, std::integer_sequence<int, I...>)
+	{
+		(f(Constant<I>()), ...);
+	}
+
+	// Calls f(0) ... f(N - 1) with constant indices. Compilers keep a loop over the vectors as a
+	// loop, and the vectors in memory with it, which puts a store and load into every iteration.
+	template<int N, typename F>
+	inline void unrolled(F&& f)
+	{
+		unrolled(f, std::make_integer_sequence<int, N>());
+	}
+
+	// S describes one instruction set: vector, mask and per-lane counter types plus
+	// the handful of operations the loop needs. S::unroll independent vectors are
+	// iterated together to hide the latency of the z^2 + c dependency chain.
+	// Every lane works on its own pixel. Once half the lanes of a vector escaped or turned out
+	// periodic, the vector writes their results and loads the next pixels of the batch, so no
+	// lane idles until the slowest pixel of a block is done. Only iteration counts come out,
+	// so escaped lanes keep iterating instead of being blended back, their z just grows to
+	// infinity or NaN, which compares false from then on.
+	template<typename S, bool checkPeriod>
+	void iterateLanes(const EscapeBatch<typename S::Scalar>& batch)
+	{
+		using T = typename S::Scalar;
+		using Vec = typename S::Vec;
+		using Mask = typename S::Mask;
+		using Count = typename S::Count;
+		constexpr int U = S::unroll;
+		constexpr int block = S::lanes * U;
+		constexpr int refillLanes = S::lanes / 2 > 0 ? S::lanes / 2 : 1;
+
+		const Vec zero = S::set1(T(0));
+		const Vec four = S::set1(T(4));
+		const Vec one = S::set1(T(1));
+		const Vec half = S::set1(T(0.5));
+		const Vec tolerance2 = S::set1(static_cast<T>(batch.periodTolerance * batch.periodTolerance));
+
+		// Lane l of vector u goes through slot u * lanes + l whenever the vector is refilled.
+		// Brent's save points differ per lane: untilSave counts the iterations to the next one and
+		// saveInterval is the iteration count it's at, which doubles with every save like nextSave
+		// does in the scalar kernel. Both stay exact in float as long as the limit is below 2^24.
+		T zrs[block], zis[block], crs[block], cis[block];
+		T savedRs[block], savedIs[block], untilSaves[block], saveIntervals[block], lives[block];
+		int pixels[block], counts[block], starts[block];
+		int next = 0;
+		// Steps since every vector was last written back, a lane started at starts[slot] reaches
+		// the limit at starts[slot] + maxIterations, deadline is the earliest of those
+		int k = 0;
+		int deadline = 0;
+
+		// Loads the next pixel that needs iterating into slot, the rest are written right away
+		auto fill = [&](int slot) {
+			while (next < batch.count)
+			{
+				int i = next++;
+				// Same test as mainComponentPeriod in the scalar kernel
+				int period = batch.rejectInterior ? mainComponentPeriod(batch.cr[i], batch.ci[i]) : 0;
+				if (period != 0 || batch.maxIterations <= 0)
+				{
+					batch.iterations[i] = period != 0 ? batch.maxIterations : 0;
+					if (batch.periods) batch.periods[i] = period;
+					continue;
+				}
+				pixels[slot] = i;
+				zrs[slot] = savedRs[slot] = batch.zr[i];
+				zis[slot] = savedIs[slot] = batch.zi[i];
+				crs[slot] = batch.cr[i];
+				cis[slot] = batch.ci[i];
+				untilSaves[slot] = saveIntervals[slot] = T(1);
+				lives[slot] = T(1);
+				counts[slot] = 0;
+				starts[slot] = k;
+				return;
+			}
+			pixels[slot] = -1;
+			zrs[slot] = zis[slot] = crs[slot] = cis[slot] = savedRs[slot] = savedIs[slot] = T(0);
+			untilSaves[slot] = saveIntervals[slot] = T(1);
+			lives[slot] = T(0);
+			counts[slot] = 0;
+		};
+		for (int slot = 0; slot < block; slot++)
+		{
+			pixels[slot] = -1;
+		}
+
+		// The vectors start out empty, so the first pass below fills all of them
+		Vec zr[U], zi[U], cr[U], ci[U], savedR[U], savedI[U], untilSave[U], saveInterval[U];
+		Mask active[U];
+		Count iter[U];
+		int activeBits[U], periodicBits[U];
+		unrolled<U>([&](auto u) {
+			zr[u] = zi[u] = cr[u] = ci[u] = savedR[u] = savedI[u] = untilSave[u] = saveInterval[u] = zero;
+			active[u] = S::lessThan(zero, zero);
+			iter[u] = S::zeroCount();
+			activeBits[u] = periodicBits[u] = 0;
+		});
+		int running = 0;
+		int refillBits = 0;
+
+		for (;;)
+		{
+			// Every vector is written back once the oldest lane reaches the limit and at the end
+			bool writeAll = running == 0 || k == deadline;
+			if (writeAll || refillBits != 0)
+			{
+				unrolled<U>([&](auto u) {
+					if (!writeAll && !((refillBits >> u) & 1)) return;
+					int offset = u * S::lanes;
+					S::store(zrs + offset, zr[u]);
+					S::store(zis + offset, zi[u]);
+					S::store(savedRs + offset, savedR[u]);
+					S::store(savedIs + offset, savedI[u]);
+					S::store(untilSaves + offset, untilSave[u]);
+					S::store(saveIntervals + offset, saveInterval[u]);
+					S::storeCount(iter[u], counts + offset);
+					for (int l = 0; l < S::lanes; l++)
+					{
+						int slot = offset + l;
+						int i = pixels[slot];
+						if (i >= 0)
+						{
+							if (((activeBits[u] >> l) & 1) && counts[slot] < batch.maxIterations) continue;
+							// The save point the orbit came back to is at half the next one
+							bool periodic = (periodicBits[u] >> l) & 1;
+							batch.iterations[i] = periodic ? batch.maxIterations : counts[slot];
+							if (batch.periods) batch.periods[i] = periodic ? counts[slot] - static_cast<int>(saveIntervals[slot]) / 2 : 0;
+						}
+						fill(slot);
+					}
+					zr[u] = S::load(zrs + offset);
+					zi[u] = S::load(zis + offset);
+					cr[u] = S::load(crs + offset);
+					ci[u] = S::load(cis + offset);
+					savedR[u] = S::load(savedRs + offset);
+					savedI[u] = S::load(savedIs + offset);
+					untilSave[u] = S::load(untilSaves + offset);
+					saveInterval[u] = S::load(saveIntervals + offset);
+					iter[u] = S::loadCount(counts + offset);
+					active[u] = S::lessThan(half, S::load(lives + offset));
+					running += countBits(static_cast<unsigned>(S::bits(active[u]))) - countBits(static_cast<unsigned>(activeBits[u]));
+					activeBits[u] = S::bits(active[u]);
+					periodicBits[u] = 0;
+				});
+				refillBits = 0;
+				if (running == 0) break;
+				if (writeAll)
+				{
+					deadline = batch.maxIterations;
+					for (int slot = 0; slot < block; slot++)
+					{
+						if (pixels[slot] < 0) continue;
+						starts[slot] -= k;
+						deadline = minimum(deadline, starts[slot] + batch.maxIterations);
+					}
+					k = 0;
+				}
+			}
+
+			k++;
+			unrolled<U>([&](auto u) {
+				Vec zr2 = S::mul(zr[u], zr[u]);
+				Vec zi2 = S::mul(zi[u], zi[u]);
+				active[u] = S::andMask(active[u], S::lessThan(S::add(zr2, zi2), four));
+				iter[u] = S::increment(iter[u], active[u]);
+
+				Vec zrzi = S::mul(zr[u], zi[u]);
+				zr[u] = S::add(S::sub(zr2, zi2), cr[u]);
+				zi[u] = S::add(S::add(zrzi, zrzi), ci[u]);
+
+				if constexpr (checkPeriod)
+				{
+					Vec dr = S::sub(zr[u], savedR[u]);
+					Vec di = S::sub(zi[u], savedI[u]);
+					Mask periodic = S::andMask(active[u], S::lessThan(S::add(S::mul(dr, dr), S::mul(di, di)), tolerance2));
+					periodicBits[u] |= S::bits(periodic);
+					active[u] = S::andNotMask(active[u], periodic);
+
+					Vec until = S::sub(untilSave[u], one);
+					Mask save = S::andMask(active[u], S::lessThan(until, half));
+					savedR[u] = S::select(save, zr[u], savedR[u]);
+					savedI[u] = S::select(save, zi[u], savedI[u]);
+					untilSave[u] = S::select(active[u], S::select(save, saveInterval[u], until), untilSave[u]);
+					saveInterval[u] = S::select(save, S::add(saveInterval[u], saveInterval[u]), saveInterval[u]);
+				}
+
+				int bits = S::bits(active[u]);
+				if (bits != activeBits[u])
+				{
+					running -= countBits(static_cast<unsigned>(activeBits[u] & ~bits));
+					activeBits[u] = bits;
+					if (next < batch.count && S::lanes - countBits(static_cast<unsigned>(bits)) >= refillLanes) refillBits |= 1 << u;
+				}
+			});
+		}
+	}
+
+	template<typename S>
+	void iterateBatch(const EscapeBatch<typename S::Scalar>& batch)
+	{
+		if (batch.periodTolerance > 0.0)
+		{
+			iterateLanes<S, true>(batch);
+		}
+		else
+		{
+			iterateLanes<S, false>(batch);
+		}
+	}
+}
+
+#endif
\ No newline at end of file
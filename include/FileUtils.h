@@ -5,6 +5,8 @@
 #include <sstream>
 #include <string>
 #include <iostream>
+#include <vector>
+#include <cstdint>
 
 class FileUtils
 {
@@ -21,6 +23,22 @@ public:
 
 	    return buffer.str();
 	}
+
+	// Binary PPM, the alpha channel of the RGBA buffer is dropped
+	static bool writePPM(const std::string& filePath, int width, int height, const std::vector<uint8_t>& rgba) {
+	    std::ofstream file(filePath, std::ios::binary);
+	    if (!file.is_open()) {
+	        std::cerr << "Failed to open file: " << filePath << std::endl;
+	        return false;
+	    }
+
+	    file << "P6\n" << width << " " << height << "\n255\n";
+	    for (size_t i = 0; i < static_cast<size_t>(width) * height; i++) {
+	        file.write(reinterpret_cast<const char*>(&rgba[i * 4]), 3);
+	    }
+
+	    return file.good();
+	}
 };
 
 #endif
\ No newline at end of file
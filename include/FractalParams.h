@@ -0,0 +1,89 @@
+#ifndef FRACTALPARAMS
+#define FRACTALPARAMS
+
+#include <BigFixed.h>
+
+#include <cmath>
+
+// Deepest supported zoom. Perturbation offsets from the reference are doubles on the CPU,
+// which stop resolving pixels not far past it.
+constexpr double maxZoom = 1e300;
+
+// Mirrors the uniforms of shader.frag so CPU and GPU paths render the same view.
+// The center is kept in arbitrary precision for deep zooms.
+struct FractalParams
+{
+	BigFixed cx = -0.5, cy = 0.0;
+	double zoom = 2.0;
+	int w = 1080, h = 1080;
+	int maxIterations = 128;
+	int baseIterations = 128;
+	float saturation = 1.0f;
+	float brightness = 1.0f;
+	double juliaCx = NAN, juliaCy = NAN;
+	bool periodicity = true;
+	// Colors interior pixels by the length of the cycle their orbit fell into
+	bool showPeriods = false;
+
+	bool isJulia() const
+	{
+		return !std::isnan(juliaCx) && !std::isnan(juliaCy);
+	}
+
+	// Whether both have the same size, zoom and fractal, whatever their center and iteration
+	// limit. NaN Julia constants compare equal.
+	bool sameFraming(const FractalParams& other) const
+	{
+		auto same = [](double a, double b) { return a == b || (std::isnan(a) && std::isnan(b)); };
+		return zoom == other.zoom && w == other.w && h == other.h && periodicity == other.periodicity
+			&& same(juliaCx, other.juliaCx) && same(juliaCy, other.juliaCy);
+	}
+
+	// Whether both iterate the same points the same way, only coloring may differ
+	bool sameEscape(const FractalParams& other) const
+	{
+		return cx == other.cx && cy == other.cy && maxIterations == other.maxIterations && sameFraming(other);
+	}
+
+	// Whether both produce the same image
+	bool operator==(const FractalParams& other) const
+	{
+		return sameEscape(other) && baseIterations == other.baseIterations
+			&& saturation == other.saturation && brightness == other.brightness
+			&& showPeriods == other.showPeriods;
+	}
+
+	bool operator!=(const FractalParams& other) const
+	{
+		return !(*this == other);
+	}
+
+	// Distance between neighbouring pixel centers, the view is 8 / zoom tall
+	double getPixelSize() const
+	{
+		return 8.0 / (zoom * h);
+	}
+
+	// Whether this is previous moved by whole pixels, dx and dy being how far previous's image
+	// moves on screen
+	bool getPixelShift(const FractalParams& previous, int& dx, int& dy) const
+	{
+		if (maxIterations != previous.maxIterations || !sameFraming(previous)) return false;
+		double x = (previous.cx - cx).toDouble() / getPixelSize();
+		double y = (previous.cy - cy).toDouble() / getPixelSize();
+		if (std::abs(x - std::round(x)) > 1e-3 || std::abs(y - std::round(y)) > 1e-3) return false;
+		if (std::abs(x) > w || std::abs(y) > h) return false;
+		dx = static_cast<int>(std::round(x));
+		dy = static_cast<int>(std::round(y));
+		return true;
+	}
+
+	// u_periodTolerance, orbits returning this close to a saved point count as periodic.
+	// Tied to the pixel spacing so the detection gets finer as the view does.
+	double getPeriodTolerance() const
+	{
+		return periodicity ? getPixelSize() * 1e-3 : 0.0;
+	}
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,72 @@
+#ifndef FRACTALPROGRAM
+#define FRACTALPROGRAM
+
+#include <PrecisionMode.h>
+#include <Shader.h>
+
+#include <cstdint>
+#include <string>
+
+// Compile-time options of the fractal shaders. The precision picks the source file, the rest
+// are #defines, so the inner loop has no branches on them.
+struct FractalVariant
+{
+	PrecisionMode precision = PrecisionMode::Float;
+	bool julia = false;
+	bool periodicity = true;
+	// Edges a 2x2 grid doesn't settle get maxGrid x maxGrid samples
+	int maxGrid = 4;
+	// Runs the passes as compute dispatches through escape.comp instead of fullscreen quads
+	bool compute = false;
+	// Escape radius, the CPU kernels use the same 2
+	int bailout = 2;
+
+	uint32_t getKey() const
+	{
+		return static_cast<uint32_t>(precision) | static_cast<uint32_t>(julia) << 2
+			| static_cast<uint32_t>(periodicity) << 3 | static_cast<uint32_t>(maxGrid) << 4
+			| static_cast<uint32_t>(compute) << 8 | static_cast<uint32_t>(bailout) << 9;
+	}
+
+	const char* getFragmentShader() const;
+	std::string getDefines() const;
+};
+
+// One fractal shader variant with its uniforms resolved once after linking. The parameters all
+// precisions share come from the FractalParameters block instead. Uniforms a program doesn't
+// declare keep location -1, which GL ignores.
+struct FractalProgram
+{
+	Shader shader;
+	bool compute;
+	// Progressive passes
+	Uniform<int> step;
+	Uniform<int> prevStep;
+	Uniform<glm::vec2> jitter;
+	Uniform<float> edgeThreshold;
+	Uniform<int> resumeFrom;
+	// The view center in whichever representation the precision uses
+	Uniform<glm::vec2> center;
+	Uniform<glm::dvec2> centerDouble;
+	Uniform<glm::vec2> centerHi;
+	Uniform<glm::vec2> centerLo;
+	// Perturbation
+	Uniform<int> deltaExponent;
+	Uniform<glm::vec2> offset;
+	Uniform<glm::vec2> viewSize;
+	Uniform<int> orbitLength;
+	Uniform<int> criticalLength;
+	Uniform<int> skipIterations;
+	Uniform<int> seriesTerms;
+	Uniform<int> seriesExponent;
+	Uniform<float> seriesRadius;
+	Uniform<glm::vec2> series;
+	// Compute dispatches
+	Uniform<glm::ivec2> tileOrigin;
+	Uniform<glm::ivec2> tileBlocks;
+	Uniform<int> edgeStage;
+
+	explicit FractalProgram(const FractalVariant& variant);
+};
+
+#endif
\ No newline at end of file
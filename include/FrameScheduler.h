@@ -0,0 +1,32 @@
+#ifndef FRAMESCHEDULER
+#define FRAMESCHEDULER
+
+// Decides when the main loop draws instead of drawing at the refresh rate. Input invalidates
+// the frame, work that spans frames like progressive passes keeps it drawing, and otherwise
+// the loop sleeps in glfwWaitEventsTimeout until the next event.
+class FrameScheduler
+{
+private:
+	// ImGui needs a couple of frames to settle after some input, e.g. hover highlights
+	static constexpr int framesPerInvalidate = 3;
+	// Idle wake up interval, only a safety net since every relevant event wakes the loop
+	static constexpr double idleTimeout = 1.0;
+	int pendingFrames = framesPerInvalidate;
+	bool busy = false;
+	bool invalidated = false;
+	double lastFrameTime = 0.0;
+public:
+	void invalidate();
+	// Whether invalidate was called since the last time this was asked
+	bool takeInvalidated();
+	// Whether the last drawn frame left work for the following ones
+	void setBusy(bool hasWork);
+	bool isIdle() const;
+
+	// Blocks until the next frame is due or an event arrives
+	void wait(double frameTime) const;
+	bool shouldDraw(double now, double frameTime) const;
+	void frameDrawn(double now);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,8 @@
+#ifndef HEADLESS
+#define HEADLESS
+
+// Renders with the CPU engine without creating a window or GL context.
+// Invoked as: FractalDive --headless [options], see printHeadlessUsage for the options.
+int runHeadless(int argc, char** argv);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,27 @@
+#ifndef ITERATIONLIMIT
+#define ITERATIONLIMIT
+
+#include <vector>
+
+// How the centers of a finished frame ended up, which tells whether its iteration limit cut
+// escaping points off or was spent on points that never escape
+struct EscapeStatistics
+{
+	int maxIterations = 0;
+	int samples = 0;
+	// Reached the limit without settling into a cycle, more iterations might still see them escape
+	int unescaped = 0;
+	// Iteration count only the slowest fraction of the escaped samples exceeded, 0 if none escaped
+	int tail = 0;
+};
+
+// centers holds vec4(iterations, smooth iterations, |z|, period) per sample, computed with maxIterations
+EscapeStatistics gatherEscapeStatistics(const std::vector<float>& centers, int maxIterations);
+// Limit for the next frame. raisedFrom are the statistics of the frame that raised the limit to
+// this one, samples 0 if it wasn't raised. Doubles while escaping samples crowd the limit or the
+// last raise let enough unescaped samples escape, and drops to a power of two with headroom over
+// the tail once it's far above it, so the limit settles instead of chasing every frame. Views
+// where nothing escapes keep their limit.
+int chooseIterationLimit(const EscapeStatistics& statistics, const EscapeStatistics& raisedFrom);
+
+#endif
\ No newline at end of file
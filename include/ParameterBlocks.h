@@ -0,0 +1,53 @@
+#ifndef PARAMETERBLOCKS
+#define PARAMETERBLOCKS
+
+#include <FractalParams.h>
+#include <GL/glew.h>
+
+// std140 mirror of the FractalParameters block every fractal shader and color.frag declare
+// at binding 0. Holds what all precisions share, the center is set per program.
+struct FractalBlock
+{
+	GLint resolution[2];
+	GLfloat zoom;
+	GLint maxIterations;
+	GLfloat juliaC[2];
+	GLfloat periodTolerance;
+	GLfloat padding;
+
+	static FractalBlock from(const FractalParams& params)
+	{
+		FractalBlock block = {};
+		block.resolution[0] = params.w;
+		block.resolution[1] = params.h;
+		block.zoom = static_cast<float>(params.zoom);
+		block.maxIterations = params.maxIterations;
+		block.juliaC[0] = static_cast<float>(params.juliaCx);
+		block.juliaC[1] = static_cast<float>(params.juliaCy);
+		block.periodTolerance = static_cast<float>(params.getPeriodTolerance());
+		return block;
+	}
+};
+static_assert(sizeof(FractalBlock) == 32, "FractalBlock must match the std140 layout");
+
+// std140 mirror of color.frag's ColorParameters block at binding 1
+struct ColorBlock
+{
+	GLint baseIterations;
+	GLfloat saturation;
+	GLfloat brightness;
+	GLfloat paletteOffset;
+
+	static ColorBlock from(const FractalParams& params, float paletteOffset)
+	{
+		ColorBlock block = {};
+		block.baseIterations = params.baseIterations;
+		block.saturation = params.saturation;
+		block.brightness = params.brightness;
+		block.paletteOffset = paletteOffset;
+		return block;
+	}
+};
+static_assert(sizeof(ColorBlock) == 16, "ColorBlock must match the std140 layout");
+
+#endif
\ No newline at end of file
@@ -0,0 +1,25 @@
+#ifndef PRECISIONMODE
+#define PRECISIONMODE
+
+#include <FractalParams.h>
+
+// GPU programs, ordered by the precision they carry
+enum class PrecisionMode
+{
+	Float,
+	DoubleSingle,
+	Double,
+	Perturbation
+};
+
+const char* getPrecisionModeName(PrecisionMode mode);
+// Mantissa bits the mode iterates with
+int getPrecisionModeBits(PrecisionMode mode);
+// Bits needed to tell neighbouring pixels apart, plus a margin for the rounding
+// errors that build up over the iterations
+int requiredPrecisionBits(const FractalParams& params);
+// Cheapest mode that resolves the view. Native doubles are preferred over the
+// emulated ones when the GPU has them.
+PrecisionMode choosePrecisionMode(const FractalParams& params, bool hasFp64);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,27 @@
+#ifndef PROGRAMCACHE
+#define PROGRAMCACHE
+
+#include <GL/glew.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Linked program binaries kept on disk so later launches skip the driver's compiler. Entries are
+// keyed by a hash of the sources and the driver's vendor, renderer and version, so a driver
+// update just misses. Does nothing where the driver has no binary formats or there's no cache
+// directory.
+class ProgramCache
+{
+private:
+	static std::string getDirectory();
+	static std::string getPath(uint64_t key);
+public:
+	static uint64_t getKey(const std::vector<std::string>& sources);
+	// Loads the cached binary into program, returns whether there was one and it linked
+	static bool load(GLuint program, uint64_t key);
+	// Saves the binary of program, which must have been linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+	static void store(GLuint program, uint64_t key);
+};
+
+#endif
\ No newline at end of file
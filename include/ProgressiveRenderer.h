@@ -0,0 +1,148 @@
+#ifndef PROGRESSIVERENDERER
+#define PROGRESSIVERENDERER
+
+#include <ColorProgram.h>
+#include <FractalProgram.h>
+#include <GL/glew.h>
+#include <VariantCache.h>
+
+#include <vector>
+
+// Spreads a frame over several passes so a preview shows up right away. The passes compute
+// one pixel per 4x4 block, then per 2x2 block, then every pixel, each skipping the pixels
+// earlier passes already computed. The last pass supersamples only the pixels whose center
+// differs from a neighbour's, flat regions keep one sample per pixel.
+// The passes only store escape data, color.frag turns it into colors whenever the image is
+// presented, so changing the colors never repeats the iteration.
+// Once the passes are done, accumulation frames add one jittered sample per pixel to a history
+// of summed colors, so a still view keeps converging. Any change restarts the accumulation,
+// except that colors which keep changing hold it and show the anti-aliased pass instead.
+// With a time budget the passes are drawn as scissored tiles, a slice of them per submit, so a
+// single draw never runs long enough to stall the compositor or trip the driver's watchdog.
+// Compute variants of the programs run the same passes as a dispatch per tile, see escape.comp.
+// A pan by whole pixels shifts the previous centers instead of starting over, only the strips it
+// exposes are computed before the frame is shown. The full resolution pass then refreshes the
+// shifted pixels in the background.
+// Every center keeps the state its iteration stopped at, so a higher iteration limit continues
+// just the centers that reached the old one in a single full resolution pass.
+class ProgressiveRenderer
+{
+private:
+	struct Region
+	{
+		int x, y, width, height;
+	};
+	static constexpr int passCount = 4;
+	static constexpr int tileSize = 128;
+	// RGBA32F vec4(iterations, smooth iterations, |z|, period) of the pixel centers
+	GLuint centers = 0;
+	// RG32I offset and count of each pixel's samples in the pool
+	GLuint sampleRanges = 0;
+	// SSBO the anti-aliasing pass allocates the edges' samples from
+	GLuint samplePool = 0;
+	// SSBO of the edge pixels the compute path supersamples, with its indirect dispatch arguments
+	GLuint edgeList = 0;
+	// SSBO of a uvec4 per pixel, where its center's iteration stopped in the packing of the precision
+	GLuint iterationStates = 0;
+	GLuint centerFramebuffer = 0;
+	GLuint rangeFramebuffer = 0;
+	int maxGrid = 4;
+	float edgeThreshold = 1.0f;
+	int poolGrid = 0;
+	// RGBA32F jittered samples of the latest accumulation frame, and the sum of the colors of
+	// all frames so far with their count in alpha
+	GLuint jitterSamples = 0;
+	GLuint history = 0;
+	GLuint jitterFramebuffer = 0;
+	GLuint historyFramebuffer = 0;
+	// RGBA32F grid the centers are scaled down to for readCenters
+	GLuint centerSamples = 0;
+	GLuint sampleFramebuffer = 0;
+	int sampleWidth = 0, sampleHeight = 0;
+	int accumulationFrames = 0;
+	int accumulated = 0;
+	bool accumulationHeld = false;
+	VariantCache<ColorVariant, ColorProgram> colorPrograms;
+	ColorVariant coloring;
+	int w = 0, h = 0;
+	int pass = 0;
+	// Next tile of the current pass
+	int tile = 0;
+	// The full resolution pass after a shift, which recomputes the pixels the block passes had too
+	bool refreshing = false;
+	// The states belong to the centers, which a shift breaks until the refresh is done
+	bool statesValid = false;
+	// The iteration limit of the centers the full resolution pass is continuing, 0 if it isn't
+	int resumeFrom = 0;
+	float timeBudget = 0.0f;
+	// GPU milliseconds per tile of each pass and of the accumulation frames, measured with a
+	// timer query around every slice
+	double tileCost[passCount + 1] = {};
+	GLuint timerQuery = 0;
+	int timedPass = 0;
+	int timedTiles = 0;
+	void release();
+	void allocatePool();
+	int getTileCount() const;
+	// Tiles [first, last), a single region when that's all of them
+	std::vector<Region> getTiles(int first, int last) const;
+	// Draws regions of the current pass, first is whether they're the start of it
+	void drawRegions(FractalProgram& program, const std::vector<Region>& regions, bool first);
+	// Compute path of drawRegions
+	void dispatchRegions(FractalProgram& program, const std::vector<Region>& regions);
+	// Colors centers with the block size step into the bound framebuffer
+	void drawColors(GLuint centerTexture, int step);
+	void finishPass();
+	void readTimerQuery();
+public:
+	ProgressiveRenderer();
+	~ProgressiveRenderer();
+	// Reallocates the buffers when the size changes, which restarts the refinement
+	void resize(int width, int height);
+	void restart();
+	bool isStarted() const;
+	// Every pixel has a center, which a shift needs
+	bool hasFullResolution() const;
+	// Share of the pixels that have a center, counting the tiles of the current pass
+	double getFullResolutionProgress() const;
+	// All passes are done, accumulation frames may still follow
+	bool hasFullImage() const;
+	bool isComplete() const;
+
+	// Edges get up to grid x grid samples, neighbours at least threshold iterations apart make
+	// an edge. grid has to be the MAX_GRID of the program the passes run with. A change only
+	// repeats the anti-aliasing pass.
+	void setSupersampling(int grid, float threshold);
+	// Jittered frames accumulated after the passes, 0 disables the accumulation.
+	// The ColorParameters block must be bound before they run.
+	void setAccumulation(int frames);
+	// Starts the accumulation over, e.g. when a setting changes
+	void restartAccumulation();
+	// Drops the accumulated frames and adds none until restartAccumulation, e.g. while the
+	// palette cycles. The history is colored, so every color change would start it over.
+	void holdAccumulation();
+	// Picks the color.frag variant, compiling it on first use
+	void setColoring(const ColorVariant& variant);
+	// Milliseconds of GPU time per slice, 0 draws every pass in one go
+	void setTimeBudget(float milliseconds);
+	// Moves the centers by dx, dy pixels and computes the exposed strips with program, whose view
+	// uniforms must already be set for the panned view. Returns false without doing anything
+	// when there's no full resolution image to move or nothing of it would stay in view.
+	bool shift(FractalProgram& program, int dx, int dy);
+	// Continues the centers computed with previousIterations up to the iteration limit the
+	// programs now have, the frame isn't shown again until that's done. Returns false without
+	// doing anything unless all centers and their states are there.
+	bool resume(int previousIterations);
+	// Reads the centers at about width x height evenly spaced pixels into samples, 4 floats each.
+	// Returns false without reading unless every center is computed for the current view.
+	bool readCenters(int width, int height, std::vector<float>& samples);
+	// Runs what's left of the current pass with program, whose view uniforms must already be set
+	void renderPass(FractalProgram& program);
+	// Runs as many tiles of the current pass as fit the time budget, returns whether that finished the pass.
+	// The caller should wait for the GPU between slices or they just queue up.
+	bool renderSlice(FractalProgram& program);
+	// Colors the latest pass into the bound framebuffer, blocks show their computed corner
+	void present();
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,45 @@
+#ifndef REFERENCEORBIT
+#define REFERENCEORBIT
+
+#include <BigFixed.h>
+#include <FractalParams.h>
+
+#include <vector>
+
+// Orbit of one point computed in arbitrary precision and stored as doubles, pixels
+// then only iterate their small offset from it (perturbation theory):
+//   delta' = 2 * Z * delta + delta^2 + deltaC
+// For Julia sets deltaC is zero and a second orbit starting at the critical point 0
+// is kept so pixels can rebase onto it, for Mandelbrot the primary orbit already starts at 0.
+class ReferenceOrbit
+{
+private:
+	BigFixed refX, refY;
+	bool julia = false;
+	double juliaCx = 0.0, juliaCy = 0.0;
+	int maxIterations = 0;
+	int fractionBits = 0;
+	std::vector<double> orbitX, orbitY;
+	std::vector<double> criticalX, criticalY;
+	static void iterate(const BigFixed& startX, const BigFixed& startY, const BigFixed& cx, const BigFixed& cy,
+		int maxIterations, std::vector<double>& outX, std::vector<double>& outY);
+public:
+	bool isValidFor(const FractalParams& params) const;
+	// Recomputes the orbit at the view center if the current one can't serve this view, returns true if it did
+	bool update(const FractalParams& params);
+	void compute(const FractalParams& params);
+
+	// Offset of the view center from the reference point
+	double offsetX(const FractalParams& params) const;
+	double offsetY(const FractalParams& params) const;
+
+	bool isJulia() const;
+	// Orbit pixels start on, Z_0 is the reference point for Julia sets and 0 for Mandelbrot
+	const std::vector<double>& getX() const;
+	const std::vector<double>& getY() const;
+	// Orbit pixels rebase onto, starting at z = 0
+	const std::vector<double>& getCriticalX() const;
+	const std::vector<double>& getCriticalY() const;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,125 @@
+#ifndef RENDERTHREAD
+#define RENDERTHREAD
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <FractalParams.h>
+#include <PrecisionMode.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// Everything the render thread needs for a frame, copied out of the application state by the
+// UI thread. Never modified while the render thread holds it.
+struct RenderSnapshot
+{
+	FractalParams params;
+	PrecisionMode precision = PrecisionMode::Float;
+	bool progressive = true;
+	// Iterates with compute shaders instead of fullscreen quads
+	bool compute = false;
+	// GPU milliseconds per submitted slice of tiles, 0 draws whole passes
+	float sliceBudget = 0.0f;
+	// Edge pixels get up to maxGrid x maxGrid samples
+	int maxGrid = 4;
+	float edgeThreshold = 1.0f;
+	// Jittered frames accumulated once the view is still, 0 disables it
+	int accumulationFrames = 0;
+	bool smoothColoring = false;
+	float paletteOffset = 0.0f;
+	// Suggests an iteration limit from every full resolution frame, see takeIterationLimit
+	bool autoIterations = false;
+
+	bool operator==(const RenderSnapshot& other) const
+	{
+		return params == other.params && precision == other.precision && progressive == other.progressive
+			&& compute == other.compute && sliceBudget == other.sliceBudget && maxGrid == other.maxGrid && edgeThreshold == other.edgeThreshold
+			&& accumulationFrames == other.accumulationFrames
+			&& smoothColoring == other.smoothColoring && paletteOffset == other.paletteOffset
+			&& autoIterations == other.autoIterations;
+	}
+
+	bool operator!=(const RenderSnapshot& other) const
+	{
+		return !(*this == other);
+	}
+
+	// Whether color.frag turns the same escape data into the same colors for both
+	bool sameColors(const RenderSnapshot& other) const
+	{
+		return params.baseIterations == other.params.baseIterations && params.saturation == other.params.saturation
+			&& params.brightness == other.params.brightness && params.showPeriods == other.params.showPeriods
+			&& smoothColoring == other.smoothColoring && paletteOffset == other.paletteOffset;
+	}
+};
+
+// Iterates the fractal on its own thread and GL context, so an expensive frame never holds up
+// input handling or ImGui. Snapshots go through a single slot mailbox that only keeps the
+// latest one, the render thread skips any it didn't get to. Snapshots it's done with wait in a
+// spare slot for the next publish to copy over. Finished images come back
+// through a triple buffer of textures shared between the contexts.
+class RenderThread
+{
+private:
+	struct Frame
+	{
+		GLuint texture = 0;
+		int w = 0, h = 0;
+		// Signaled once the UI thread is done blitting it, waited on before drawing over it
+		GLsync presented = nullptr;
+	};
+	// Set on the middle index while the UI thread hasn't taken that frame yet
+	static constexpr int freshFrame = 4;
+
+	GLFWwindow* context;
+	std::thread thread;
+	std::atomic<RenderSnapshot*> mailbox{nullptr};
+	// A snapshot nobody uses anymore, kept so publishing doesn't allocate
+	std::atomic<RenderSnapshot*> spare{nullptr};
+	std::atomic<bool> running{false};
+	// Only used to sleep while there is nothing to render
+	std::mutex wakeMutex;
+	std::condition_variable wake;
+
+	// Ownership of a frame moves by swapping indices, the render thread draws into back and
+	// the UI thread blits front
+	Frame frames[3];
+	std::atomic<int> middle{0};
+	int back = 1;
+	int front = 2;
+	GLuint readFramebuffer = 0;
+	std::atomic<int> skippedIterations{0};
+	// Limit the escape statistics of the latest frame asked for, 0 once taken
+	std::atomic<int> iterationLimit{0};
+	// Milliseconds per million pixels the latest timed view took to get a center for every pixel, 0 once taken
+	std::atomic<float> pixelCost{0.0f};
+
+	void run();
+	// Keeps snapshot as the spare, either thread may hand one back
+	void recycle(RenderSnapshot* snapshot);
+public:
+	// context is a hidden window whose context shares objects with the UI thread's one
+	explicit RenderThread(GLFWwindow* context);
+	~RenderThread();
+	void start();
+	// Joins the thread, must be called on the UI thread with its context current
+	void stop();
+
+	// Replaces the snapshot the render thread works on next, never blocks
+	void publish(const RenderSnapshot& snapshot);
+	bool hasNewFrame() const;
+	// Blits the newest finished frame over the w x h draw framebuffer, scaling it if it was
+	// rendered at another size. False before the first one.
+	bool present(int w, int h);
+	// Of the latest perturbation frame
+	int getSkippedIterations() const;
+	// A new iteration limit when the last frame with autoIterations needs one, otherwise 0
+	int takeIterationLimit();
+	// A new measurement of the cost of a view per million pixels, otherwise 0. Only views that
+	// start over are timed, estimated from their progress if another one interrupts them.
+	float takePixelCost();
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,33 @@
+#ifndef RESOLUTIONGOVERNOR
+#define RESOLUTIONGOVERNOR
+
+// Sizes the render target relative to the framebuffer. While the view moves the target shrinks
+// until a changed view reaches full resolution within the frame budget, once it rests the
+// target goes back to the idle scale, which may also supersample. The cost of a view is
+// measured per pixel, so one measurement predicts it at any scale.
+class ResolutionGovernor
+{
+private:
+	static constexpr double minScale = 0.25;
+	// Scales are multiples of this, so small changes in the cost don't restart the frame
+	static constexpr double scaleStep = 0.125;
+	// Share of the scale that fits the budget a larger one has to stay under
+	static constexpr double raiseMargin = 0.9;
+	// Seconds without a view change before the idle scale returns
+	static constexpr double idleDelay = 0.5;
+	double idleScale = 1.0;
+	double movingScale = 1.0;
+	// Milliseconds per million pixels, averaged over the measurements
+	double pixelCost = 0.0;
+	double lastMove = -idleDelay;
+public:
+	void setIdleScale(double scale);
+	void viewMoved(double now);
+	bool isMoving(double now) const;
+	// Takes a new cost per million pixels, 0 if there is none, and the milliseconds a frame
+	// may take for a framebuffer of pixels
+	void update(double cost, double budget, int pixels);
+	double getScale(double now) const;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,43 @@
+#ifndef SERIESAPPROXIMATION
+#define SERIESAPPROXIMATION
+
+#include <FractalParams.h>
+#include <ReferenceOrbit.h>
+
+#include <vector>
+
+// Taylor series of a pixel's perturbation offset in terms of its initial offset d,
+//   delta_n = a_1 * d + a_2 * d^2 + ... + a_K * d^K
+// computed once along the reference orbit so every pixel can start at iteration N
+// instead of 0. Coefficients are stored scaled by radius^k, where radius bounds |d|
+// over the view, which keeps them finite at any zoom. N is the last iteration at
+// which the series still matches directly iterated probe points across the view.
+class SeriesApproximation
+{
+private:
+	int terms;
+	double tolerance;
+	int skipIterations = 0;
+	double radius = 1.0;
+	std::vector<double> coefficientsX, coefficientsY;
+	// Inputs of the last computation, so unchanged views reuse it
+	double lastOffsetX = 0.0, lastOffsetY = 0.0, lastZoom = 0.0;
+	int lastW = 0, lastH = 0, lastMaxIterations = 0;
+public:
+	explicit SeriesApproximation(int terms = 8, double tolerance = 1e-6);
+	void compute(const ReferenceOrbit& orbit, const FractalParams& params);
+	// Recomputes if the orbit changed or the view moved, returns true if it did
+	bool update(const ReferenceOrbit& orbit, const FractalParams& params, bool orbitChanged);
+	void reset();
+
+	int getSkipIterations() const;
+	int getTerms() const;
+	double getRadius() const;
+	const std::vector<double>& getCoefficientsX() const;
+	const std::vector<double>& getCoefficientsY() const;
+	// Offset at the skipped iteration for a pixel whose initial offset is (dx, dy),
+	// deltaC for Mandelbrot and delta z for Julia sets
+	void evaluate(double dx, double dy, double& outX, double& outY) const;
+};
+
+#endif
\ No newline at end of file
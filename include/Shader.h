@@ -2,24 +2,52 @@
 #define SHADER
 
 #include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <initializer_list>
 #include <string>
+#include <vector>
+
+// Location of a uniform, looked up once after linking. T is the GLSL type, it picks the
+// matching Shader::set overload. -1 if the program has no such active uniform.
+template<typename T>
+struct Uniform
+{
+	GLint location = -1;
+};
 
 class Shader
 {
 private:
 	GLuint programID;
 	GLuint loadShader(GLuint type, const std::string& source);
+	// Concatenates the embedded files in order and lists their names
+	static std::string concatenate(std::initializer_list<const char*> files, std::string& name);
+	// Compiles and links the stages, unless the cache has the program already
+	void link(const std::vector<GLenum>& types, const std::vector<std::string>& sources, const std::string& name);
 public:
-	Shader(const std::string& vertexShader, const std::string& fragmentShader);
+	// Takes the file names of embedded shaders, e.g. "shader.vert". The fragment shader is the files
+	// concatenated in order, defines are inserted right after the first one's #version line.
+	// Reuses the cached binary when there is one.
+	Shader(const std::string& vertexShader, std::initializer_list<const char*> fragmentShaders, const std::string& defines = "");
+	// Compute program from the embedded files concatenated in order, defines go after the
+	// first one's #version line
+	Shader(std::initializer_list<const char*> computeShaders, const std::string& defines);
 	~Shader();
 	void use() const;
 	GLuint getProgramID() const;
 
-	//Uniforms
-	void setUniform1f(const std::string& name, float value);
-	void setUniform2f(const std::string& name, float val1, float val2);
-	void setUniform1i(const std::string& name, int value);
-	void setUniform2i(const std::string& name, int val1, int val2);
+	// Cached uniforms, set through glProgramUniform so the program doesn't need to be bound
+	template<typename T>
+	Uniform<T> getUniform(const char* name) const
+	{
+		return Uniform<T>{glGetUniformLocation(programID, name)};
+	}
+	void set(Uniform<float> uniform, float value) const;
+	void set(Uniform<int> uniform, int value) const;
+	void set(Uniform<glm::vec2> uniform, float x, float y) const;
+	void set(Uniform<glm::ivec2> uniform, int x, int y) const;
+	void set(Uniform<glm::dvec2> uniform, double x, double y) const;
+	void set(Uniform<glm::vec2> uniform, int count, const float* values) const;
 };
 
 #endif
\ No newline at end of file
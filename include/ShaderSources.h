@@ -0,0 +1,26 @@
+#ifndef SHADERSOURCES
+#define SHADERSOURCES
+
+#include <cstddef>
+#include <string>
+
+// The GLSL files of src/shaders, compiled into the executable by cmake/EmbedShaders.cmake so it
+// doesn't depend on the working directory
+class ShaderSources
+{
+private:
+	struct File
+	{
+		const char* name;
+		const unsigned char* data;
+		size_t size;
+	};
+	// Defined in the generated EmbeddedShaders.cpp
+	static const File files[];
+	static const int fileCount;
+public:
+	// Source of the file name, e.g. "color.frag". Empty if there's no such shader.
+	static std::string get(const std::string& name);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,35 @@
+#ifndef THREADPOOL
+#define THREADPOOL
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+class ThreadPool
+{
+private:
+	std::vector<std::thread> workers;
+	std::queue<std::function<void()>> tasks;
+	std::mutex mutex;
+	std::condition_variable taskAvailable;
+	std::condition_variable allDone;
+	size_t activeTasks = 0;
+	bool stopping = false;
+	void workerLoop();
+public:
+	// 0 threads means one per hardware thread
+	explicit ThreadPool(unsigned int threadCount = 0);
+	~ThreadPool();
+	unsigned int size() const;
+
+	// Tasks may submit further tasks, wait() returns once the queue has drained
+	// and no task is running. Must not be called from inside a task.
+	void submit(std::function<void()> task);
+	void wait();
+	void parallelFor(int count, const std::function<void(int)>& body);
+};
+
+#endif
\ No newline at end of file
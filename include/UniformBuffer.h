@@ -0,0 +1,47 @@
+#ifndef UNIFORMBUFFER
+#define UNIFORMBUFFER
+
+#include <GL/glew.h>
+
+#include <cstring>
+
+// Uniform buffer holding one std140 block T at a fixed binding point. Uploads are skipped
+// while the contents stay the same, so it can be fed every frame.
+template<typename T>
+class UniformBuffer
+{
+private:
+	GLuint buffer = 0;
+	T contents = {};
+	bool uploaded = false;
+public:
+	explicit UniformBuffer(GLuint binding)
+	{
+		glGenBuffers(1, &buffer);
+		glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+		glBufferData(GL_UNIFORM_BUFFER, sizeof(T), nullptr, GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		glBindBufferBase(GL_UNIFORM_BUFFER, binding, buffer);
+	}
+
+	~UniformBuffer()
+	{
+		glDeleteBuffers(1, &buffer);
+	}
+
+	UniformBuffer(const UniformBuffer&) = delete;
+	UniformBuffer& operator=(const UniformBuffer&) = delete;
+
+	// Blocks are compared bytewise, so T should be zero initialized padding included
+	void upload(const T& values)
+	{
+		if (uploaded && std::memcmp(&contents, &values, sizeof(T)) == 0) return;
+		contents = values;
+		uploaded = true;
+		glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(T), &values);
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	}
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,28 @@
+#ifndef VARIANTCACHE
+#define VARIANTCACHE
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+// Programs compiled from the #define permutations of the same sources. Each variant is compiled
+// the first time it's asked for and kept, so switching back to it is just a program bind.
+// Variant needs a getKey() unique among its permutations, Program a constructor taking the Variant.
+template<typename Variant, typename Program>
+class VariantCache
+{
+private:
+	std::unordered_map<uint32_t, std::unique_ptr<Program>> programs;
+public:
+	Program& get(const Variant& variant)
+	{
+		std::unique_ptr<Program>& program = programs[variant.getKey()];
+		if (!program)
+		{
+			program = std::make_unique<Program>(variant);
+		}
+		return *program;
+	}
+};
+
+#endif
\ No newline at end of file
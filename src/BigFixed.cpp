@@ -0,0 +1,359 @@
+#include <BigFixed.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+
+BigFixed::BigFixed(double value, int fractionBits)
+	: limbs((std::max(fractionBits, 0) + 31) / 32 + 1, 0)
+{
+	negative = value < 0.0;
+	double x = std::fabs(value);
+	if (std::isnan(x)) x = 0.0;
+	x = std::min(x, 4294967295.0);
+
+	// Peeling 32 bits at a time is exact, scaling by powers of two never rounds
+	int f = fractionLimbs();
+	double integer = std::floor(x);
+	limbs[f] = static_cast<uint32_t>(integer);
+	double fraction = x - integer;
+	for (int i = f - 1; i >= 0 && fraction > 0.0; i--)
+	{
+		fraction = std::ldexp(fraction, 32);
+		double limb = std::floor(fraction);
+		limbs[i] = static_cast<uint32_t>(limb);
+		fraction -= limb;
+	}
+	if (isZero()) negative = false;
+}
+
+bool BigFixed::fromString(const std::string& text, int fractionBits, BigFixed& result)
+{
+	size_t pos = 0;
+	bool isNegative = false;
+	if (pos < text.size() && (text[pos] == '-' || text[pos] == '+'))
+	{
+		isNegative = text[pos] == '-';
+		pos++;
+	}
+
+	std::string integerDigits, fractionDigits;
+	while (pos < text.size() && std::isdigit(static_cast<unsigned char>(text[pos]))) integerDigits += text[pos++];
+	if (pos < text.size() && text[pos] == '.')
+	{
+		pos++;
+		while (pos < text.size() && std::isdigit(static_cast<unsigned char>(text[pos]))) fractionDigits += text[pos++];
+	}
+	if (integerDigits.empty() && fractionDigits.empty()) return false;
+
+	int exponent = 0;
+	if (pos < text.size() && (text[pos] == 'e' || text[pos] == 'E'))
+	{
+		pos++;
+		size_t end;
+		try
+		{
+			exponent = std::stoi(text.substr(pos), &end);
+		}
+		catch (...)
+		{
+			return false;
+		}
+		pos += end;
+	}
+	if (pos != text.size()) return false;
+
+	// A guard limb absorbs the truncation of the repeated divisions
+	BigFixed value(0.0, fractionBits + 32);
+	int f = value.fractionLimbs();
+	for (auto it = fractionDigits.rbegin(); it != fractionDigits.rend(); ++it)
+	{
+		value.limbs[f] = static_cast<uint32_t>(*it - '0');
+		value.divideSmall(10);
+	}
+	uint64_t integer = 0;
+	for (char digit : integerDigits)
+	{
+		integer = integer * 10 + (digit - '0');
+		if (integer > 0xFFFFFFFFull) return false;
+	}
+	value.limbs[f] = static_cast<uint32_t>(integer);
+
+	for (; exponent > 0; exponent--)
+	{
+		if (value.multiplySmall(10) != 0) return false;
+	}
+	for (; exponent < 0; exponent++)
+	{
+		value.divideSmall(10);
+	}
+
+	value.setFractionBits(fractionBits);
+	value.negative = isNegative && !value.isZero();
+	result = value;
+	return true;
+}
+
+int BigFixed::bitsForZoom(double zoom)
+{
+	// Pixels are about 1/zoom apart, the extra 64 bits keep a double's worth below that
+	return 64 + (zoom > 1.0 ? static_cast<int>(std::ceil(std::log2(zoom))) : 0);
+}
+
+int BigFixed::fractionLimbs() const
+{
+	return static_cast<int>(limbs.size()) - 1;
+}
+
+int BigFixed::getFractionBits() const
+{
+	return fractionLimbs() * 32;
+}
+
+void BigFixed::setFractionBits(int bits)
+{
+	int target = (std::max(bits, 0) + 31) / 32;
+	int current = fractionLimbs();
+	if (target > current)
+	{
+		limbs.insert(limbs.begin(), target - current, 0);
+	}
+	else if (target < current)
+	{
+		limbs.erase(limbs.begin(), limbs.begin() + (current - target));
+		if (isZero()) negative = false;
+	}
+}
+
+void BigFixed::ensureFractionBits(int bits)
+{
+	if (bits > getFractionBits())
+	{
+		setFractionBits(bits);
+	}
+}
+
+bool BigFixed::isZero() const
+{
+	return std::all_of(limbs.begin(), limbs.end(), [](uint32_t limb) { return limb == 0; });
+}
+
+double BigFixed::toDouble() const
+{
+	int top = fractionLimbs();
+	while (top > 0 && limbs[top] == 0) top--;
+
+	// Three limbs cover the 53 bit mantissa wherever the leading bit falls
+	double result = 0.0;
+	for (int i = top; i >= 0 && i > top - 3; i--)
+	{
+		result += std::ldexp(static_cast<double>(limbs[i]), 32 * (i - fractionLimbs()));
+	}
+	return negative ? -result : result;
+}
+
+std::string BigFixed::toString(int digits) const
+{
+	std::string result = negative ? "-" : "";
+	result += std::to_string(limbs.back());
+	result += '.';
+
+	BigFixed fraction = *this;
+	for (int i = 0; i < digits; i++)
+	{
+		fraction.limbs.back() = 0;
+		fraction.multiplySmall(10);
+		result += static_cast<char>('0' + fraction.limbs.back());
+	}
+	while (result.back() == '0' && result[result.size() - 2] != '.') result.pop_back();
+	return result;
+}
+
+int BigFixed::compareMagnitude(const BigFixed& other) const
+{
+	for (int i = fractionLimbs(); i >= 0; i--)
+	{
+		if (limbs[i] != other.limbs[i]) return limbs[i] < other.limbs[i] ? -1 : 1;
+	}
+	return 0;
+}
+
+void BigFixed::addMagnitude(const BigFixed& other)
+{
+	uint64_t carry = 0;
+	for (size_t i = 0; i < limbs.size(); i++)
+	{
+		uint64_t sum = static_cast<uint64_t>(limbs[i]) + other.limbs[i] + carry;
+		limbs[i] = static_cast<uint32_t>(sum);
+		carry = sum >> 32;
+	}
+}
+
+void BigFixed::subtractMagnitude(const BigFixed& other)
+{
+	// Callers guarantee |this| >= |other|
+	int64_t borrow = 0;
+	for (size_t i = 0; i < limbs.size(); i++)
+	{
+		int64_t diff = static_cast<int64_t>(limbs[i]) - other.limbs[i] - borrow;
+		borrow = diff < 0 ? 1 : 0;
+		limbs[i] = static_cast<uint32_t>(diff + (borrow << 32));
+	}
+}
+
+uint32_t BigFixed::multiplySmall(uint32_t factor)
+{
+	uint64_t carry = 0;
+	for (size_t i = 0; i < limbs.size(); i++)
+	{
+		uint64_t product = static_cast<uint64_t>(limbs[i]) * factor + carry;
+		limbs[i] = static_cast<uint32_t>(product);
+		carry = product >> 32;
+	}
+	return static_cast<uint32_t>(carry);
+}
+
+void BigFixed::divideSmall(uint32_t divisor)
+{
+	uint64_t remainder = 0;
+	for (int i = fractionLimbs(); i >= 0; i--)
+	{
+		uint64_t current = (remainder << 32) | limbs[i];
+		limbs[i] = static_cast<uint32_t>(current / divisor);
+		remainder = current % divisor;
+	}
+}
+
+BigFixed BigFixed::operator-() const
+{
+	BigFixed result = *this;
+	if (!result.isZero()) result.negative = !negative;
+	return result;
+}
+
+BigFixed& BigFixed::operator+=(const BigFixed& other)
+{
+	if (other.fractionLimbs() != fractionLimbs())
+	{
+		int bits = std::max(getFractionBits(), other.getFractionBits());
+		setFractionBits(bits);
+		if (other.fractionLimbs() != fractionLimbs())
+		{
+			BigFixed aligned = other;
+			aligned.setFractionBits(bits);
+			return *this += aligned;
+		}
+	}
+
+	if (negative == other.negative)
+	{
+		addMagnitude(other);
+	}
+	else if (compareMagnitude(other) >= 0)
+	{
+		subtractMagnitude(other);
+	}
+	else
+	{
+		BigFixed result = other;
+		result.subtractMagnitude(*this);
+		*this = std::move(result);
+	}
+	if (isZero()) negative = false;
+	return *this;
+}
+
+BigFixed& BigFixed::operator-=(const BigFixed& other)
+{
+	return *this += -other;
+}
+
+BigFixed BigFixed::operator+(const BigFixed& other) const
+{
+	BigFixed result = *this;
+	result += other;
+	return result;
+}
+
+BigFixed BigFixed::operator-(const BigFixed& other) const
+{
+	BigFixed result = *this;
+	result -= other;
+	return result;
+}
+
+BigFixed BigFixed::operator*(const BigFixed& other) const
+{
+	if (other.fractionLimbs() != fractionLimbs())
+	{
+		int bits = std::max(getFractionBits(), other.getFractionBits());
+		BigFixed a = *this, b = other;
+		a.setFractionBits(bits);
+		b.setFractionBits(bits);
+		return a * b;
+	}
+
+	// Schoolbook product, the lowest f limbs fall below the precision and the top ones overflow the integer part
+	int f = fractionLimbs();
+	int n = f + 1;
+	std::vector<uint32_t> product(2 * n, 0);
+	for (int i = 0; i < n; i++)
+	{
+		if (limbs[i] == 0) continue;
+		uint64_t carry = 0;
+		for (int j = 0; j < n; j++)
+		{
+			uint64_t t = static_cast<uint64_t>(limbs[i]) * other.limbs[j] + product[i + j] + carry;
+			product[i + j] = static_cast<uint32_t>(t);
+			carry = t >> 32;
+		}
+		product[i + n] = static_cast<uint32_t>(carry);
+	}
+
+	BigFixed result(0.0, getFractionBits());
+	std::copy(product.begin() + f, product.begin() + f + n, result.limbs.begin());
+	result.negative = (negative != other.negative) && !result.isZero();
+	return result;
+}
+
+BigFixed BigFixed::operator+(double other) const
+{
+	return *this + BigFixed(other, getFractionBits());
+}
+
+BigFixed BigFixed::operator-(double other) const
+{
+	return *this - BigFixed(other, getFractionBits());
+}
+
+BigFixed& BigFixed::operator+=(double other)
+{
+	return *this += BigFixed(other, getFractionBits());
+}
+
+BigFixed& BigFixed::operator-=(double other)
+{
+	return *this -= BigFixed(other, getFractionBits());
+}
+
+bool BigFixed::operator==(const BigFixed& other) const
+{
+	// Limbs aligned at the integer part, those past the shorter fraction count as zeros.
+	// Compared in place, the render loop does this every slice.
+	int fraction = fractionLimbs();
+	int otherFraction = other.fractionLimbs();
+	bool zero = true;
+	for (int i = -std::max(fraction, otherFraction); i <= 0; i++)
+	{
+		uint32_t limb = i + fraction >= 0 ? limbs[i + fraction] : 0;
+		uint32_t otherLimb = i + otherFraction >= 0 ? other.limbs[i + otherFraction] : 0;
+		if (limb != otherLimb) return false;
+		zero = zero && limb == 0;
+	}
+	return zero || negative == other.negative;
+}
+
+bool BigFixed::operator!=(const BigFixed& other) const
+{
+	return !(*this == other);
+}
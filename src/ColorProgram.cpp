@@ -0,0 +1,11 @@
+#include <ColorProgram.h>
+
+ColorProgram::ColorProgram(const ColorVariant& variant)
+	: shader("shader.vert", {"color.frag"}, variant.getDefines())
+{
+	step = shader.getUniform<int>("u_step");
+	// ProgressiveRenderer binds the textures to the same units every time
+	shader.set(shader.getUniform<int>("u_centers"), 0);
+	shader.set(shader.getUniform<int>("u_sampleRanges"), 1);
+	shader.set(shader.getUniform<int>("u_history"), 2);
+}
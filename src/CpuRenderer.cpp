@@ -0,0 +1,572 @@
+#include <CpuRenderer.h>
+
+#include <algorithm>
+#include <cmath>
+
+struct Color
+{
+	float r, g, b;
+};
+
+static float fract(float x)
+{
+	return x - std::floor(x);
+}
+
+static Color hsvToRgb(float h, float s, float v)
+{
+	float p = v * (1.0f - s);
+	float q = v * (1.0f - s * fract(h * 6.0f));
+	float t = v * (1.0f - s * (1.0f - fract(h * 6.0f)));
+
+	if (h < 1.0f/6.0f) return {v, t, p};
+	if (h < 2.0f/6.0f) return {q, v, p};
+	if (h < 3.0f/6.0f) return {p, v, t};
+	if (h < 4.0f/6.0f) return {p, q, v};
+	if (h < 5.0f/6.0f) return {t, p, v};
+	return {v, p, q};
+}
+
+static Color iterationColor(const FractalParams& params, int iter, int period = 0)
+{
+	if (iter == params.maxIterations)
+	{
+		if (params.showPeriods && period > 0)
+		{
+			return hsvToRgb(fract(period * 0.618034f), params.saturation, params.brightness * 0.5f);
+		}
+		return {0.0f, 0.0f, 0.0f};
+	}
+	float t = static_cast<float>(iter) / static_cast<float>(params.baseIterations);
+	float hue = fract(t * 5.0f);
+	return hsvToRgb(hue, params.saturation, params.brightness);
+}
+
+// Offsets are in the [-1, 1] position space of shader.vert. Sample 0 is the pixel center
+// weighted 0.5, the other four form the quincunx corners weighted 0.125 each, as in shader.frag
+static constexpr int numSamples = 5;
+static const double offsets[numSamples][2] = {
+	{ 0.0,   0.0},
+	{-0.25, -0.25},
+	{ 0.25, -0.25},
+	{-0.25,  0.25},
+	{ 0.25,  0.25}
+};
+static const float weights[numSamples] = {0.5f, 0.125f, 0.125f, 0.125f, 0.125f};
+
+static uint8_t toUnorm8(float x)
+{
+	return static_cast<uint8_t>(std::lround(std::clamp(x, 0.0f, 1.0f) * 255.0f));
+}
+
+CpuRenderer::CpuRenderer(unsigned int threadCount, int tileSize)
+	: pool(threadCount), tileSize(tileSize), kernels(&getEscapeKernels())
+{
+}
+
+unsigned int CpuRenderer::getThreadCount() const
+{
+	return pool.size();
+}
+
+void CpuRenderer::setKernels(const EscapeKernels& escapeKernels)
+{
+	kernels = &escapeKernels;
+}
+
+const EscapeKernels& CpuRenderer::getKernels() const
+{
+	return *kernels;
+}
+
+void CpuRenderer::setSinglePrecision(bool enabled)
+{
+	singlePrecision = enabled;
+}
+
+void CpuRenderer::setPerturbation(bool enabled)
+{
+	perturbation = enabled;
+}
+
+void CpuRenderer::setSeriesApproximation(bool enabled)
+{
+	seriesApproximation = enabled;
+}
+
+int CpuRenderer::getSkippedIterations() const
+{
+	return series.getSkipIterations();
+}
+
+void CpuRenderer::setSubdivision(bool enabled)
+{
+	subdivision = enabled;
+}
+
+bool CpuRenderer::needsPerturbation(const FractalParams& params)
+{
+	// Pixel spacing relative to the center magnitude, with a few bits of margin
+	double spacing = 8.0 / (params.zoom * params.h);
+	double magnitude = std::max({std::fabs(params.cx.toDouble()), std::fabs(params.cy.toDouble()), 1.0});
+	return spacing < magnitude * 1e-12;
+}
+
+void CpuRenderer::render(const FractalParams& params, std::vector<uint8_t>& rgba)
+{
+	rgba.resize(static_cast<size_t>(params.w) * params.h * 4);
+
+	bool deep = perturbation || needsPerturbation(params);
+	if (deep)
+	{
+		bool orbitChanged = referenceOrbit.update(params);
+		if (seriesApproximation)
+		{
+			series.update(referenceOrbit, params, orbitChanged);
+		}
+		else
+		{
+			series.reset();
+		}
+	}
+
+	int tilesX = (params.w + tileSize - 1) / tileSize;
+	int tilesY = (params.h + tileSize - 1) / tileSize;
+	uint8_t* out = rgba.data();
+	int* keys = nullptr;
+	if (subdivision)
+	{
+		sampleKeys.resize(static_cast<size_t>(params.w) * params.h);
+		keys = sampleKeys.data();
+	}
+
+	pool.parallelFor(tilesX * tilesY, [&](int tile) {
+		int x0 = (tile % tilesX) * tileSize;
+		int y0 = (tile / tilesX) * tileSize;
+		int x1 = std::min(x0 + tileSize, params.w);
+		int y1 = std::min(y0 + tileSize, params.h);
+		std::vector<size_t> pixels;
+		if (!subdivision)
+		{
+			// One batch for the whole tile keeps the SIMD lanes busy, they refill from the pixels left
+			for (int y = y0; y < y1; y++) addRow(pixels, params.w, y, x0, x1);
+			renderPixelList(params, deep, pixels, out, keys);
+			return;
+		}
+		addRow(pixels, params.w, y0, x0, x1);
+		if (y1 - y0 > 1) addRow(pixels, params.w, y1 - 1, x0, x1);
+		addColumn(pixels, params.w, x0, y0 + 1, y1 - 1);
+		if (x1 - x0 > 1) addColumn(pixels, params.w, x1 - 1, y0 + 1, y1 - 1);
+		renderPixelList(params, deep, pixels, out, keys);
+		subdivide(params, deep, x0, y0, x1, y1, out, keys);
+	});
+}
+
+// Pairs each of the next coordinates with the closest previous one within tolerance. Both are
+// sorted along direction, 1 or -1, and the pairs keep that order so no line is used twice.
+// Returns the index into previous, or -1 for lines that have to be iterated.
+static std::vector<int> matchLines(const std::vector<double>& previous, const std::vector<double>& next, double direction, double tolerance)
+{
+	std::vector<int> sources(next.size(), -1);
+	size_t j = 0;
+	for (size_t i = 0; i < next.size(); i++)
+	{
+		double target = next[i] * direction;
+		while (j < previous.size() && previous[j] * direction < target - tolerance) j++;
+		if (j == previous.size()) break;
+		size_t best = j;
+		if (j + 1 < previous.size() && std::fabs(previous[j + 1] * direction - target) < std::fabs(previous[j] * direction - target))
+		{
+			best = j + 1;
+		}
+		if (std::fabs(previous[best] * direction - target) > tolerance) continue;
+		sources[i] = static_cast<int>(best);
+		j = best + 1;
+	}
+	return sources;
+}
+
+double CpuRenderer::renderZoom(const FractalParams& params, std::vector<uint8_t>& rgba)
+{
+	double aspectRatio = static_cast<double>(params.w) / params.h;
+	double scaleX = 4.0 * aspectRatio / params.zoom;
+	double scaleY = 4.0 / params.zoom;
+	double cx = params.cx.toDouble();
+	double cy = params.cy.toDouble();
+	std::vector<double> columns(params.w), rows(params.h);
+	for (int x = 0; x < params.w; x++)
+	{
+		columns[x] = cx + ((x + 0.5) * 2.0 / params.w - 1.0) * scaleX;
+	}
+	for (int y = 0; y < params.h; y++)
+	{
+		rows[y] = cy + ((params.h - y - 0.5) * 2.0 / params.h - 1.0) * scaleY;
+	}
+
+	FractalParams moved = zoomParams;
+	moved.cx = params.cx;
+	moved.cy = params.cy;
+	moved.zoom = params.zoom;
+	if (zoomFrame.empty() || moved != params || perturbation || needsPerturbation(params))
+	{
+		render(params, rgba);
+		zoomParams = params;
+		zoomColumns = columns;
+		zoomRows = rows;
+		zoomFrame = rgba;
+		return 1.0;
+	}
+
+	// Rows are top-down, so their imaginary parts decrease
+	double tolerance = 0.5 * params.getPixelSize();
+	std::vector<int> columnSources = matchLines(zoomColumns, columns, 1.0, tolerance);
+	std::vector<int> rowSources = matchLines(zoomRows, rows, -1.0, tolerance);
+	for (int x = 0; x < params.w; x++)
+	{
+		if (columnSources[x] >= 0) columns[x] = zoomColumns[columnSources[x]];
+	}
+	for (int y = 0; y < params.h; y++)
+	{
+		if (rowSources[y] >= 0) rows[y] = zoomRows[rowSources[y]];
+	}
+
+	rgba.resize(static_cast<size_t>(params.w) * params.h * 4);
+	std::vector<size_t> pixels;
+	for (int y = 0; y < params.h; y++)
+	{
+		for (int x = 0; x < params.w; x++)
+		{
+			size_t index = static_cast<size_t>(y) * params.w + x;
+			if (rowSources[y] < 0 || columnSources[x] < 0)
+			{
+				pixels.push_back(index);
+				continue;
+			}
+			const uint8_t* source = zoomFrame.data() + (static_cast<size_t>(rowSources[y]) * params.w + columnSources[x]) * 4;
+			std::copy(source, source + 4, rgba.data() + index * 4);
+		}
+	}
+
+	zoomColumns = columns;
+	zoomRows = rows;
+	onZoomGrid = true;
+	// Batches big enough to fill the kernels' vectors, a new line is scattered over the tiles
+	constexpr size_t batchSize = 1024;
+	int batches = static_cast<int>((pixels.size() + batchSize - 1) / batchSize);
+	uint8_t* out = rgba.data();
+	pool.parallelFor(batches, [&](int batch) {
+		auto first = pixels.begin() + batch * batchSize;
+		auto last = pixels.begin() + std::min(pixels.size(), (batch + 1) * batchSize);
+		renderPixelList(params, false, std::vector<size_t>(first, last), out, nullptr);
+	});
+	onZoomGrid = false;
+	zoomParams = params;
+	zoomFrame = rgba;
+	return static_cast<double>(pixels.size()) / (static_cast<double>(params.w) * params.h);
+}
+
+void CpuRenderer::addRow(std::vector<size_t>& pixels, int w, int y, int x0, int x1)
+{
+	for (int x = x0; x < x1; x++) pixels.push_back(static_cast<size_t>(y) * w + x);
+}
+
+void CpuRenderer::addColumn(std::vector<size_t>& pixels, int w, int x, int y0, int y1)
+{
+	for (int y = y0; y < y1; y++) pixels.push_back(static_cast<size_t>(y) * w + x);
+}
+
+void CpuRenderer::renderPixelList(const FractalParams& params, bool deep, const std::vector<size_t>& pixels, uint8_t* rgba, int* keys) const
+{
+	if (deep)
+	{
+		renderPixelsPerturbation(params, pixels, rgba, keys);
+	}
+	else if (singlePrecision)
+	{
+		renderPixels<float>(params, pixels, rgba, keys);
+	}
+	else
+	{
+		renderPixels<double>(params, pixels, rgba, keys);
+	}
+}
+
+// Whether the pixel centers of the rectangle surround 0 in the plane being iterated. The
+// Mandelbrot set and connected Julia sets contain it, and a rectangle enclosing one of them
+// can have an escaping border without its inside escaping at the same iteration.
+static bool containsOrigin(const FractalParams& params, int x0, int y0, int x1, int y1)
+{
+	double pixelW = 2.0 / params.w;
+	double pixelH = 2.0 / params.h;
+	double aspectRatio = static_cast<double>(params.w) / params.h;
+	double scaleX = 4.0 * aspectRatio / params.zoom;
+	double scaleY = 4.0 / params.zoom;
+	double cx = params.cx.toDouble();
+	double cy = params.cy.toDouble();
+	double left = cx + ((x0 + 0.5) * pixelW - 1.0) * scaleX;
+	double right = cx + ((x1 - 0.5) * pixelW - 1.0) * scaleX;
+	double top = cy + ((params.h - y0 - 0.5) * pixelH - 1.0) * scaleY;
+	double bottom = cy + ((params.h - y1 + 0.5) * pixelH - 1.0) * scaleY;
+	return left <= 0.0 && right >= 0.0 && bottom <= 0.0 && top >= 0.0;
+}
+
+// The border of [x0, x1) x [y0, y1) has been rendered. If every border pixel has the same
+// iteration count in all of its samples the inside gets the same color, otherwise the
+// rectangle is cut into four by a middle row and column, whose pixels become the borders
+// of the quarters. Large quarters go to the pool, the inside of small ones is just rendered.
+void CpuRenderer::subdivide(const FractalParams& params, bool deep, int x0, int y0, int x1, int y1, uint8_t* rgba, int* keys)
+{
+	constexpr int minSize = 16;
+	constexpr int minTaskArea = 32 * 32;
+	int w = params.w;
+	if (x1 - x0 <= 2 || y1 - y0 <= 2) return;
+
+	int key = keys[static_cast<size_t>(y0) * w + x0];
+	bool uniform = key >= 0;
+	for (int x = x0; x < x1 && uniform; x++)
+	{
+		uniform = keys[static_cast<size_t>(y0) * w + x] == key && keys[static_cast<size_t>(y1 - 1) * w + x] == key;
+	}
+	for (int y = y0 + 1; y < y1 - 1 && uniform; y++)
+	{
+		uniform = keys[static_cast<size_t>(y) * w + x0] == key && keys[static_cast<size_t>(y) * w + x1 - 1] == key;
+	}
+	if (uniform && key < params.maxIterations && containsOrigin(params, x0, y0, x1, y1))
+	{
+		uniform = false;
+	}
+	// Brent's check can report a multiple of the actual period, so period colored regions aren't solid
+	if (key > params.maxIterations)
+	{
+		uniform = false;
+	}
+
+	if (uniform)
+	{
+		const uint8_t* color = rgba + (static_cast<size_t>(y0) * w + x0) * 4;
+		for (int y = y0 + 1; y < y1 - 1; y++)
+		{
+			for (int x = x0 + 1; x < x1 - 1; x++)
+			{
+				uint8_t* pixel = rgba + (static_cast<size_t>(y) * w + x) * 4;
+				std::copy(color, color + 4, pixel);
+			}
+		}
+		return;
+	}
+
+	// Pixels are gathered into one list per step so the kernels still get full vectors
+	std::vector<size_t> pixels;
+	if (x1 - x0 <= minSize || y1 - y0 <= minSize)
+	{
+		for (int y = y0 + 1; y < y1 - 1; y++) addRow(pixels, w, y, x0 + 1, x1 - 1);
+		renderPixelList(params, deep, pixels, rgba, keys);
+		return;
+	}
+
+	int mx = (x0 + x1) / 2;
+	int my = (y0 + y1) / 2;
+	addRow(pixels, w, my, x0 + 1, x1 - 1);
+	addColumn(pixels, w, mx, y0 + 1, my);
+	addColumn(pixels, w, mx, my + 1, y1 - 1);
+	renderPixelList(params, deep, pixels, rgba, keys);
+
+	const int quarters[4][4] = {
+		{x0, y0, mx + 1, my + 1},
+		{mx, y0, x1, my + 1},
+		{x0, my, mx + 1, y1},
+		{mx, my, x1, y1}
+	};
+	for (const int* q : quarters)
+	{
+		int qx0 = q[0], qy0 = q[1], qx1 = q[2], qy1 = q[3];
+		if ((qx1 - qx0) * (qy1 - qy0) >= minTaskArea)
+		{
+			pool.submit([this, &params, deep, qx0, qy0, qx1, qy1, rgba, keys] {
+				subdivide(params, deep, qx0, qy0, qx1, qy1, rgba, keys);
+			});
+		}
+		else
+		{
+			subdivide(params, deep, qx0, qy0, qx1, qy1, rgba, keys);
+		}
+	}
+}
+
+static void iterate(const EscapeKernels& kernels, const EscapeBatch<double>& batch)
+{
+	kernels.iterateDouble(batch);
+}
+
+static void iterate(const EscapeKernels& kernels, const EscapeBatch<float>& batch)
+{
+	kernels.iterateFloat(batch);
+}
+
+template<typename T>
+void CpuRenderer::renderPixels(const FractalParams& params, const std::vector<size_t>& pixels, uint8_t* rgba, int* keys) const
+{
+	double pixelW = 2.0 / params.w;
+	double pixelH = 2.0 / params.h;
+	double aspectRatio = static_cast<double>(params.w) / params.h;
+	double scaleX = 4.0 * aspectRatio / params.zoom;
+	double scaleY = 4.0 / params.zoom;
+	double cx = params.cx.toDouble();
+	double cy = params.cy.toDouble();
+	bool julia = params.isJulia();
+
+	// All samples go into one batch, sample s of pixel i at s * n + i
+	int n = static_cast<int>(pixels.size());
+	int count = n * numSamples;
+	std::vector<T> pr(count), pi(count);
+	// Only one of z0 = 0 or the constant Julia c is needed
+	std::vector<T> zero(julia ? 0 : count, T(0));
+	std::vector<T> jr(julia ? count : 0, T(params.juliaCx)), ji(julia ? count : 0, T(params.juliaCy));
+	std::vector<int> iterations(count), periods(params.showPeriods ? count : 0);
+
+	for (int i = 0; i < n; i++)
+	{
+		int x = static_cast<int>(pixels[i] % params.w);
+		int y = static_cast<int>(pixels[i] / params.w);
+		double u = (x + 0.5) * pixelW - 1.0;
+		// Buffer rows are top-down while gl_FragCoord grows upwards
+		double v = (params.h - y - 0.5) * pixelH - 1.0;
+		for (int s = 0; s < numSamples; s++)
+		{
+			int j = s * n + i;
+			if (onZoomGrid)
+			{
+				pr[j] = static_cast<T>(zoomColumns[x] + offsets[s][0] * pixelW * scaleX);
+				pi[j] = static_cast<T>(zoomRows[y] + offsets[s][1] * pixelH * scaleY);
+				continue;
+			}
+			pr[j] = static_cast<T>(cx + (u + offsets[s][0] * pixelW) * scaleX);
+			pi[j] = static_cast<T>(cy + (v + offsets[s][1] * pixelH) * scaleY);
+		}
+	}
+
+	EscapeBatch<T> batch;
+	batch.zr = julia ? pr.data() : zero.data();
+	batch.zi = julia ? pi.data() : zero.data();
+	batch.cr = julia ? jr.data() : pr.data();
+	batch.ci = julia ? ji.data() : pi.data();
+	batch.count = count;
+	batch.maxIterations = params.maxIterations;
+	batch.iterations = iterations.data();
+	batch.rejectInterior = !julia;
+	batch.periodTolerance = params.getPeriodTolerance();
+	batch.periods = params.showPeriods ? periods.data() : nullptr;
+	iterate(*kernels, batch);
+
+	for (int i = 0; i < n; i++)
+	{
+		float r = 0.0f, g = 0.0f, b = 0.0f;
+		int key = iterations[i] + (params.showPeriods ? periods[i] : 0);
+		for (int s = 0; s < numSamples; s++)
+		{
+			int j = s * n + i;
+			int period = params.showPeriods ? periods[j] : 0;
+			Color c = iterationColor(params, iterations[j], period);
+			r += c.r * weights[s];
+			g += c.g * weights[s];
+			b += c.b * weights[s];
+			// Periods are only nonzero at maxIterations, so the sum identifies the color
+			if (iterations[j] + period != key) key = -1;
+		}
+
+		if (keys) keys[pixels[i]] = key;
+		uint8_t* pixel = rgba + pixels[i] * 4;
+		pixel[0] = toUnorm8(r);
+		pixel[1] = toUnorm8(g);
+		pixel[2] = toUnorm8(b);
+		pixel[3] = 255;
+	}
+}
+
+// Iterates the pixel's offset from the reference orbit in double precision. When the pixel
+// comes closer to 0 than its offset, or the reference runs out, it rebases onto the orbit
+// starting at 0, which keeps the offsets small and avoids glitches. Iteration starts at
+// startIteration with the offset given by the series approximation.
+static int perturbedEscapeTime(const ReferenceOrbit& orbit, double dzr, double dzi, double dcr, double dci, int startIteration, int maxIterations)
+{
+	const double* zx = orbit.getX().data();
+	const double* zy = orbit.getY().data();
+	int length = static_cast<int>(orbit.getX().size());
+
+	int m = startIteration;
+	int iter = startIteration;
+	while (iter < maxIterations)
+	{
+		double Zr = zx[m], Zi = zy[m];
+		double zr = Zr + dzr, zi = Zi + dzi;
+		double magnitude = zr * zr + zi * zi;
+		if (magnitude >= 4.0) break;
+
+		if (magnitude < dzr * dzr + dzi * dzi || m == length - 1)
+		{
+			zx = orbit.getCriticalX().data();
+			zy = orbit.getCriticalY().data();
+			length = static_cast<int>(orbit.getCriticalX().size());
+			m = 0;
+			Zr = zx[0];
+			Zi = zy[0];
+			dzr = zr - Zr;
+			dzi = zi - Zi;
+		}
+
+		double nextDr = 2.0 * (Zr * dzr - Zi * dzi) + dzr * dzr - dzi * dzi + dcr;
+		double nextDi = 2.0 * (Zr * dzi + Zi * dzr) + 2.0 * dzr * dzi + dci;
+		dzr = nextDr;
+		dzi = nextDi;
+		m++;
+		iter++;
+	}
+	return iter;
+}
+
+void CpuRenderer::renderPixelsPerturbation(const FractalParams& params, const std::vector<size_t>& pixels, uint8_t* rgba, int* keys) const
+{
+	double pixelW = 2.0 / params.w;
+	double pixelH = 2.0 / params.h;
+	double aspectRatio = static_cast<double>(params.w) / params.h;
+	double scaleX = 4.0 * aspectRatio / params.zoom;
+	double scaleY = 4.0 / params.zoom;
+	double offsetX = referenceOrbit.offsetX(params);
+	double offsetY = referenceOrbit.offsetY(params);
+	bool julia = referenceOrbit.isJulia();
+	int skip = series.getSkipIterations();
+
+	for (size_t index : pixels)
+	{
+		double u = (static_cast<int>(index % params.w) + 0.5) * pixelW - 1.0;
+		double v = (params.h - static_cast<int>(index / params.w) - 0.5) * pixelH - 1.0;
+		float r = 0.0f, g = 0.0f, b = 0.0f;
+		int key = 0;
+		for (int s = 0; s < numSamples; s++)
+		{
+			double dx = offsetX + (u + offsets[s][0] * pixelW) * scaleX;
+			double dy = offsetY + (v + offsets[s][1] * pixelH) * scaleY;
+			double dzr = julia ? dx : 0.0, dzi = julia ? dy : 0.0;
+			if (skip > 0)
+			{
+				series.evaluate(dx, dy, dzr, dzi);
+			}
+			int iter = julia
+				? perturbedEscapeTime(referenceOrbit, dzr, dzi, 0.0, 0.0, skip, params.maxIterations)
+				: perturbedEscapeTime(referenceOrbit, dzr, dzi, dx, dy, skip, params.maxIterations);
+			Color c = iterationColor(params, iter);
+			r += c.r * weights[s];
+			g += c.g * weights[s];
+			b += c.b * weights[s];
+			if (s == 0) key = iter;
+			else if (iter != key) key = -1;
+		}
+
+		if (keys) keys[index] = key;
+		uint8_t* pixel = rgba + index * 4;
+		pixel[0] = toUnorm8(r);
+		pixel[1] = toUnorm8(g);
+		pixel[2] = toUnorm8(b);
+		pixel[3] = 255;
+	}
+}
@@ -0,0 +1,159 @@
+#include <EscapeKernelsSimd.h>
+
+#if defined(FRACTALDIVE_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Reference loop, written exactly like computeFragColor with |z| < 2 tested as |z|^2 < 4
+template<typename T>
+static void iterateScalar(const EscapeBatch<T>& batch)
+{
+	bool checkPeriod = batch.periodTolerance > 0.0;
+	T tolerance2 = static_cast<T>(batch.periodTolerance * batch.periodTolerance);
+	for (int i = 0; i < batch.count; i++)
+	{
+		T zr = batch.zr[i], zi = batch.zi[i];
+		T cr = batch.cr[i], ci = batch.ci[i];
+		int period = batch.rejectInterior ? mainComponentPeriod(cr, ci) : 0;
+		if (period != 0)
+		{
+			batch.iterations[i] = batch.maxIterations;
+			if (batch.periods) batch.periods[i] = period;
+			continue;
+		}
+		T savedR = zr, savedI = zi;
+		int savedAt = 0, nextSave = 1;
+		int iter = 0;
+		while (zr * zr + zi * zi < T(4) && iter < batch.maxIterations)
+		{
+			T tmp = zr * zr - zi * zi + cr;
+			zi = zr * zi + zi * zr + ci;
+			zr = tmp;
+			iter++;
+
+			if (checkPeriod)
+			{
+				T dr = zr - savedR, di = zi - savedI;
+				if (dr * dr + di * di < tolerance2)
+				{
+					period = iter - savedAt;
+					iter = batch.maxIterations;
+					break;
+				}
+				if (iter == nextSave)
+				{
+					savedR = zr;
+					savedI = zi;
+					savedAt = iter;
+					nextSave *= 2;
+				}
+			}
+		}
+		batch.iterations[i] = iter;
+		if (batch.periods) batch.periods[i] = period;
+	}
+}
+
+static void iterateDoubleScalar(const EscapeBatch<double>& batch)
+{
+	iterateScalar(batch);
+}
+
+static void iterateFloatScalar(const EscapeBatch<float>& batch)
+{
+	iterateScalar(batch);
+}
+
+static const EscapeKernels scalarKernels = {SimdIsa::Scalar, "scalar", iterateDoubleScalar, iterateFloatScalar};
+#ifdef FRACTALDIVE_X86
+static const EscapeKernels sse2Kernels = {SimdIsa::SSE2, "sse2", iterateDoubleSSE2, iterateFloatSSE2};
+static const EscapeKernels avx2Kernels = {SimdIsa::AVX2, "avx2", iterateDoubleAVX2, iterateFloatAVX2};
+static const EscapeKernels avx512Kernels = {SimdIsa::AVX512, "avx512", iterateDoubleAVX512, iterateFloatAVX512};
+#endif
+
+static const EscapeKernels& kernelsFor(SimdIsa isa)
+{
+#ifdef FRACTALDIVE_X86
+	switch (isa)
+	{
+	case SimdIsa::SSE2: return sse2Kernels;
+	case SimdIsa::AVX2: return avx2Kernels;
+	case SimdIsa::AVX512: return avx512Kernels;
+	default: break;
+	}
+#endif
+	return scalarKernels;
+}
+
+bool isSimdIsaSupported(SimdIsa isa)
+{
+	if (isa == SimdIsa::Scalar) return true;
+#if !defined(FRACTALDIVE_X86)
+	return false;
+#elif defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	int maxLeaf = info[0];
+	__cpuid(info, 1);
+	bool sse2 = (info[3] & (1 << 26)) != 0;
+	bool avx = (info[2] & (1 << 28)) != 0;
+	bool osxsave = (info[2] & (1 << 27)) != 0;
+	// The OS has to save the YMM/ZMM registers on context switches as well
+	unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+	bool ymmEnabled = (xcr0 & 0x6) == 0x6;
+	bool zmmEnabled = (xcr0 & 0xE6) == 0xE6;
+	int leaf7[4] = {0, 0, 0, 0};
+	if (maxLeaf >= 7) __cpuidex(leaf7, 7, 0);
+	switch (isa)
+	{
+	case SimdIsa::SSE2: return sse2;
+	case SimdIsa::AVX2: return avx && ymmEnabled && (leaf7[1] & (1 << 5)) != 0;
+	case SimdIsa::AVX512: return avx && zmmEnabled && (leaf7[1] & (1 << 16)) != 0;
+	default: return false;
+	}
+#else
+	__builtin_cpu_init();
+	switch (isa)
+	{
+	case SimdIsa::SSE2: return __builtin_cpu_supports("sse2");
+	case SimdIsa::AVX2: return __builtin_cpu_supports("avx2");
+	case SimdIsa::AVX512: return __builtin_cpu_supports("avx512f");
+	default: return false;
+	}
+#endif
+}
+
+SimdIsa detectSimdIsa()
+{
+	static const SimdIsa best = [] {
+		for (SimdIsa isa : {SimdIsa::AVX512, SimdIsa::AVX2, SimdIsa::SSE2})
+		{
+			if (isSimdIsaSupported(isa)) return isa;
+		}
+		return SimdIsa::Scalar;
+	}();
+	return best;
+}
+
+bool parseSimdIsa(const std::string& name, SimdIsa& isa)
+{
+	for (SimdIsa candidate : {SimdIsa::Scalar, SimdIsa::SSE2, SimdIsa::AVX2, SimdIsa::AVX512})
+	{
+		if (name == kernelsFor(candidate).name)
+		{
+			isa = candidate;
+			return true;
+		}
+	}
+	return false;
+}
+
+const EscapeKernels& getEscapeKernels(SimdIsa isa)
+{
+	return kernelsFor(isSimdIsaSupported(isa) ? isa : detectSimdIsa());
+}
+
+const EscapeKernels& getEscapeKernels()
+{
+	return kernelsFor(detectSimdIsa());
+}
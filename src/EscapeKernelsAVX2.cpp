@@ -0,0 +1,80 @@
+#include <EscapeKernelsSimd.h>
+
+#ifdef FRACTALDIVE_X86
+
+#include <immintrin.h>
+
+#include <cstdint>
+
+namespace
+{
+	struct AVX2Double
+	{
+		using Scalar = double;
+		using Vec = __m256d;
+		using Mask = __m256d;
+		using Count = __m256i;
+		static constexpr int lanes = 4;
+		static constexpr int unroll = 4;
+
+		static Vec load(const double* p) { return _mm256_loadu_pd(p); }
+		static void store(double* p, Vec v) { _mm256_storeu_pd(p, v); }
+		static Vec set1(double x) { return _mm256_set1_pd(x); }
+		static Vec add(Vec a, Vec b) { return _mm256_add_pd(a, b); }
+		static Vec sub(Vec a, Vec b) { return _mm256_sub_pd(a, b); }
+		static Vec mul(Vec a, Vec b) { return _mm256_mul_pd(a, b); }
+		static Mask lessThan(Vec a, Vec b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+		static Mask andMask(Mask a, Mask b) { return _mm256_and_pd(a, b); }
+		static Mask andNotMask(Mask a, Mask b) { return _mm256_andnot_pd(b, a); }
+		static int bits(Mask m) { return _mm256_movemask_pd(m); }
+		static Vec select(Mask m, Vec a, Vec b) { return _mm256_blendv_pd(b, a, m); }
+		static Count zeroCount() { return _mm256_setzero_si256(); }
+		// Active lanes are all ones, i.e. -1
+		static Count increment(Count c, Mask m) { return _mm256_sub_epi64(c, _mm256_castpd_si256(m)); }
+		static void storeCount(Count c, int* out)
+		{
+			int64_t counts[lanes];
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(counts), c);
+			for (int l = 0; l < lanes; l++) out[l] = static_cast<int>(counts[l]);
+		}
+		static Count loadCount(const int* in) { return _mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in))); }
+	};
+
+	struct AVX2Float
+	{
+		using Scalar = float;
+		using Vec = __m256;
+		using Mask = __m256;
+		using Count = __m256i;
+		static constexpr int lanes = 8;
+		static constexpr int unroll = 4;
+
+		static Vec load(const float* p) { return _mm256_loadu_ps(p); }
+		static void store(float* p, Vec v) { _mm256_storeu_ps(p, v); }
+		static Vec set1(float x) { return _mm256_set1_ps(x); }
+		static Vec add(Vec a, Vec b) { return _mm256_add_ps(a, b); }
+		static Vec sub(Vec a, Vec b) { return _mm256_sub_ps(a, b); }
+		static Vec mul(Vec a, Vec b) { return _mm256_mul_ps(a, b); }
+		static Mask lessThan(Vec a, Vec b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+		static Mask andMask(Mask a, Mask b) { return _mm256_and_ps(a, b); }
+		static Mask andNotMask(Mask a, Mask b) { return _mm256_andnot_ps(b, a); }
+		static int bits(Mask m) { return _mm256_movemask_ps(m); }
+		static Vec select(Mask m, Vec a, Vec b) { return _mm256_blendv_ps(b, a, m); }
+		static Count zeroCount() { return _mm256_setzero_si256(); }
+		static Count increment(Count c, Mask m) { return _mm256_sub_epi32(c, _mm256_castps_si256(m)); }
+		static void storeCount(Count c, int* out) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), c); }
+		static Count loadCount(const int* in) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in)); }
+	};
+}
+
+void iterateDoubleAVX2(const EscapeBatch<double>& batch)
+{
+	iterateBatch<AVX2Double>(batch);
+}
+
+void iterateFloatAVX2(const EscapeBatch<float>& batch)
+{
+	iterateBatch<AVX2Float>(batch);
+}
+
+#endif
@@ -0,0 +1,72 @@
+#include <EscapeKernelsSimd.h>
+
+#ifdef FRACTALDIVE_X86
+
+#include <immintrin.h>
+
+namespace
+{
+	struct AVX512Double
+	{
+		using Scalar = double;
+		using Vec = __m512d;
+		using Mask = __mmask8;
+		using Count = __m512i;
+		static constexpr int lanes = 8;
+		static constexpr int unroll = 4;
+
+		static Vec load(const double* p) { return _mm512_loadu_pd(p); }
+		static void store(double* p, Vec v) { _mm512_storeu_pd(p, v); }
+		static Vec set1(double x) { return _mm512_set1_pd(x); }
+		static Vec add(Vec a, Vec b) { return _mm512_add_pd(a, b); }
+		static Vec sub(Vec a, Vec b) { return _mm512_sub_pd(a, b); }
+		static Vec mul(Vec a, Vec b) { return _mm512_mul_pd(a, b); }
+		static Mask lessThan(Vec a, Vec b) { return _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ); }
+		static Mask andMask(Mask a, Mask b) { return static_cast<Mask>(a & b); }
+		static Mask andNotMask(Mask a, Mask b) { return static_cast<Mask>(a & ~b); }
+		static int bits(Mask m) { return m; }
+		static Vec select(Mask m, Vec a, Vec b) { return _mm512_mask_blend_pd(m, b, a); }
+		static Count zeroCount() { return _mm512_setzero_si512(); }
+		static Count increment(Count c, Mask m) { return _mm512_mask_add_epi64(c, m, c, _mm512_set1_epi64(1)); }
+		static void storeCount(Count c, int* out) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm512_cvtepi64_epi32(c)); }
+		static Count loadCount(const int* in) { return _mm512_cvtepi32_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in))); }
+	};
+
+	struct AVX512Float
+	{
+		using Scalar = float;
+		using Vec = __m512;
+		using Mask = __mmask16;
+		using Count = __m512i;
+		static constexpr int lanes = 16;
+		static constexpr int unroll = 4;
+
+		static Vec load(const float* p) { return _mm512_loadu_ps(p); }
+		static void store(float* p, Vec v) { _mm512_storeu_ps(p, v); }
+		static Vec set1(float x) { return _mm512_set1_ps(x); }
+		static Vec add(Vec a, Vec b) { return _mm512_add_ps(a, b); }
+		static Vec sub(Vec a, Vec b) { return _mm512_sub_ps(a, b); }
+		static Vec mul(Vec a, Vec b) { return _mm512_mul_ps(a, b); }
+		static Mask lessThan(Vec a, Vec b) { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+		static Mask andMask(Mask a, Mask b) { return static_cast<Mask>(a & b); }
+		static Mask andNotMask(Mask a, Mask b) { return static_cast<Mask>(a & ~b); }
+		static int bits(Mask m) { return m; }
+		static Vec select(Mask m, Vec a, Vec b) { return _mm512_mask_blend_ps(m, b, a); }
+		static Count zeroCount() { return _mm512_setzero_si512(); }
+		static Count increment(Count c, Mask m) { return _mm512_mask_add_epi32(c, m, c, _mm512_set1_epi32(1)); }
+		static void storeCount(Count c, int* out) { _mm512_storeu_si512(out, c); }
+		static Count loadCount(const int* in) { return _mm512_loadu_si512(in); }
+	};
+}
+
+void iterateDoubleAVX512(const EscapeBatch<double>& batch)
+{
+	iterateBatch<AVX512Double>(batch);
+}
+
+void iterateFloatAVX512(const EscapeBatch<float>& batch)
+{
+	iterateBatch<AVX512Float>(batch);
+}
+
+#endif
@@ -0,0 +1,80 @@
+#include <EscapeKernelsSimd.h>
+
+#ifdef FRACTALDIVE_X86
+
+#include <emmintrin.h>
+
+#include <cstdint>
+
+namespace
+{
+	struct SSE2Double
+	{
+		using Scalar = double;
+		using Vec = __m128d;
+		using Mask = __m128d;
+		using Count = __m128i;
+		static constexpr int lanes = 2;
+		static constexpr int unroll = 4;
+
+		static Vec load(const double* p) { return _mm_loadu_pd(p); }
+		static void store(double* p, Vec v) { _mm_storeu_pd(p, v); }
+		static Vec set1(double x) { return _mm_set1_pd(x); }
+		static Vec add(Vec a, Vec b) { return _mm_add_pd(a, b); }
+		static Vec sub(Vec a, Vec b) { return _mm_sub_pd(a, b); }
+		static Vec mul(Vec a, Vec b) { return _mm_mul_pd(a, b); }
+		static Mask lessThan(Vec a, Vec b) { return _mm_cmplt_pd(a, b); }
+		static Mask andMask(Mask a, Mask b) { return _mm_and_pd(a, b); }
+		static Mask andNotMask(Mask a, Mask b) { return _mm_andnot_pd(b, a); }
+		static int bits(Mask m) { return _mm_movemask_pd(m); }
+		static Vec select(Mask m, Vec a, Vec b) { return _mm_or_pd(_mm_and_pd(m, a), _mm_andnot_pd(m, b)); }
+		static Count zeroCount() { return _mm_setzero_si128(); }
+		// Active lanes are all ones, i.e. -1
+		static Count increment(Count c, Mask m) { return _mm_sub_epi64(c, _mm_castpd_si128(m)); }
+		static void storeCount(Count c, int* out)
+		{
+			int64_t counts[lanes];
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(counts), c);
+			for (int l = 0; l < lanes; l++) out[l] = static_cast<int>(counts[l]);
+		}
+		static Count loadCount(const int* in) { return _mm_set_epi64x(in[1], in[0]); }
+	};
+
+	struct SSE2Float
+	{
+		using Scalar = float;
+		using Vec = __m128;
+		using Mask = __m128;
+		using Count = __m128i;
+		static constexpr int lanes = 4;
+		static constexpr int unroll = 4;
+
+		static Vec load(const float* p) { return _mm_loadu_ps(p); }
+		static void store(float* p, Vec v) { _mm_storeu_ps(p, v); }
+		static Vec set1(float x) { return _mm_set1_ps(x); }
+		static Vec add(Vec a, Vec b) { return _mm_add_ps(a, b); }
+		static Vec sub(Vec a, Vec b) { return _mm_sub_ps(a, b); }
+		static Vec mul(Vec a, Vec b) { return _mm_mul_ps(a, b); }
+		static Mask lessThan(Vec a, Vec b) { return _mm_cmplt_ps(a, b); }
+		static Mask andMask(Mask a, Mask b) { return _mm_and_ps(a, b); }
+		static Mask andNotMask(Mask a, Mask b) { return _mm_andnot_ps(b, a); }
+		static int bits(Mask m) { return _mm_movemask_ps(m); }
+		static Vec select(Mask m, Vec a, Vec b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+		static Count zeroCount() { return _mm_setzero_si128(); }
+		static Count increment(Count c, Mask m) { return _mm_sub_epi32(c, _mm_castps_si128(m)); }
+		static void storeCount(Count c, int* out) { _mm_storeu_si128(reinterpret_cast<__m128i*>(out), c); }
+		static Count loadCount(const int* in) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(in)); }
+	};
+}
+
+void iterateDoubleSSE2(const EscapeBatch<double>& batch)
+{
+	iterateBatch<SSE2Double>(batch);
+}
+
+void iterateFloatSSE2(const EscapeBatch<float>& batch)
+{
+	iterateBatch<SSE2Float>(batch);
+}
+
+#endif
@@ -0,0 +1,63 @@
+#include <FractalProgram.h>
+
+const char* FractalVariant::getFragmentShader() const
+{
+	switch (precision)
+	{
+	case PrecisionMode::DoubleSingle: return "doublesingle.frag";
+	case PrecisionMode::Double: return "double.frag";
+	case PrecisionMode::Perturbation: return "perturbation.frag";
+	default: return "shader.frag";
+	}
+}
+
+std::string FractalVariant::getDefines() const
+{
+	std::string defines;
+	if (julia) defines += "#define JULIA\n";
+	if (periodicity) defines += "#define PERIODICITY\n";
+	defines += "#define MAX_GRID " + std::to_string(maxGrid) + "\n";
+	defines += "#define BAILOUT " + std::to_string(bailout) + ".0\n";
+	if (compute) defines += "#define COMPUTE\n";
+	return defines;
+}
+
+static Shader createShader(const FractalVariant& variant)
+{
+	if (variant.compute)
+	{
+		return Shader({variant.getFragmentShader(), "passes.glsl", "escape.comp"}, variant.getDefines());
+	}
+	return Shader("shader.vert", {variant.getFragmentShader(), "passes.glsl"}, variant.getDefines());
+}
+
+FractalProgram::FractalProgram(const FractalVariant& variant)
+	: shader(createShader(variant)), compute(variant.compute)
+{
+	step = shader.getUniform<int>("u_step");
+	prevStep = shader.getUniform<int>("u_prevStep");
+	jitter = shader.getUniform<glm::vec2>("u_jitter");
+	edgeThreshold = shader.getUniform<float>("u_edgeThreshold");
+	resumeFrom = shader.getUniform<int>("u_resumeFrom");
+	deltaExponent = shader.getUniform<int>("u_deltaExponent");
+	offset = shader.getUniform<glm::vec2>("u_offset");
+	viewSize = shader.getUniform<glm::vec2>("u_viewSize");
+	orbitLength = shader.getUniform<int>("u_orbitLength");
+	criticalLength = shader.getUniform<int>("u_criticalLength");
+	skipIterations = shader.getUniform<int>("u_skipIterations");
+	seriesTerms = shader.getUniform<int>("u_seriesTerms");
+	seriesExponent = shader.getUniform<int>("u_seriesExponent");
+	seriesRadius = shader.getUniform<float>("u_seriesRadius");
+	series = shader.getUniform<glm::vec2>("u_series");
+	centerHi = shader.getUniform<glm::vec2>("u_centerHi");
+	centerLo = shader.getUniform<glm::vec2>("u_centerLo");
+	tileOrigin = shader.getUniform<glm::ivec2>("u_tileOrigin");
+	tileBlocks = shader.getUniform<glm::ivec2>("u_tileBlocks");
+	edgeStage = shader.getUniform<int>("u_edgeStage");
+	// u_center is a dvec2 in double.frag and a vec2 elsewhere, the caller picks by precision
+	center = shader.getUniform<glm::vec2>("u_center");
+	centerDouble = shader.getUniform<glm::dvec2>("u_center");
+
+	// The anti-aliasing pass always finds the centers on unit 0
+	shader.set(shader.getUniform<int>("u_centers"), 0);
+}
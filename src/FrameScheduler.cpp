@@ -0,0 +1,55 @@
+#include <FrameScheduler.h>
+
+#include <GLFW/glfw3.h>
+
+void FrameScheduler::invalidate()
+{
+	pendingFrames = framesPerInvalidate;
+	invalidated = true;
+}
+
+bool FrameScheduler::takeInvalidated()
+{
+	bool wasInvalidated = invalidated;
+	invalidated = false;
+	return wasInvalidated;
+}
+
+void FrameScheduler::setBusy(bool hasWork)
+{
+	busy = hasWork;
+}
+
+bool FrameScheduler::isIdle() const
+{
+	return !busy && pendingFrames == 0;
+}
+
+void FrameScheduler::wait(double frameTime) const
+{
+	if (isIdle())
+	{
+		glfwWaitEventsTimeout(idleTimeout);
+		return;
+	}
+	double remaining = lastFrameTime + frameTime - glfwGetTime();
+	if (remaining > 0.0)
+	{
+		glfwWaitEventsTimeout(remaining);
+	}
+	else
+	{
+		glfwPollEvents();
+	}
+}
+
+bool FrameScheduler::shouldDraw(double now, double frameTime) const
+{
+	return !isIdle() && now - lastFrameTime >= frameTime;
+}
+
+void FrameScheduler::frameDrawn(double now)
+{
+	lastFrameTime = now;
+	if (pendingFrames > 0) pendingFrames--;
+}
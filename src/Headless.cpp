@@ -0,0 +1,214 @@
+#include <Headless.h>
+#include <CpuRenderer.h>
+#include <FileUtils.h>
+#include <FractalParams.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static void printHeadlessUsage()
+{
+	std::cout << "Usage: FractalDive --headless [options]\n"
+		<< "  --output <file.ppm>    Image to write (default fractal.ppm)\n"
+		<< "  --size <w> <h>         Image size in pixels (default 1080 1080)\n"
+		<< "  --center <x> <y>       View center, any number of decimals (default -0.5 0)\n"
+		<< "  --zoom <z>             Zoom level, up to about 1e300 (default 2)\n"
+		<< "  --iterations <n>       u_MAX_ITERATIONS (default 128)\n"
+		<< "  --base-iterations <n>  u_BASE_ITERATIONS (default 128)\n"
+		<< "  --julia <x> <y>        Render the Julia set for c = x + yi\n"
+		<< "  --color <s> <v>        Saturation and brightness (default 1 1)\n"
+		<< "  --threads <n>          Worker threads, 0 uses all cores (default 0)\n"
+		<< "  --isa <name>           Kernel to use: scalar, sse2, avx2 or avx512 (default: best supported)\n"
+		<< "  --float                Iterate in single precision like the shader\n"
+		<< "  --perturbation         Iterate offsets from a high precision reference orbit,\n"
+		<< "                         always used once the zoom is too deep for doubles\n"
+		<< "  --no-series            Don't skip iterations with the series approximation\n"
+		<< "  --no-periodicity       Iterate interior points to the limit instead of detecting cycles\n"
+		<< "  --show-periods         Color interior points by the period of their cycle\n"
+		<< "  --subdivide            Fill rectangles with a uniform border without iterating them\n"
+		<< "  --frames <n>           Render n times and report timings (default 1)\n"
+		<< "  --zoom-step <f>        Multiply the zoom by f every frame after the first, reusing the\n"
+		<< "                         rows and columns of the previous frame (1.1 is a scroll step)\n";
+}
+
+int runHeadless(int argc, char** argv)
+{
+	FractalParams params;
+	std::string output = "fractal.ppm";
+	unsigned int threads = 0;
+	int frames = 1;
+	double zoomStep = 0.0;
+	SimdIsa isa = detectSimdIsa();
+	bool singlePrecision = false;
+	bool perturbation = false;
+	bool series = true;
+	bool subdivide = false;
+	std::string centerX = "-0.5", centerY = "0";
+
+	for (int i = 2; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		auto hasValues = [&](int count) { return i + count < argc; };
+
+		if (arg == "--output" && hasValues(1))
+		{
+			output = argv[++i];
+		}
+		else if (arg == "--size" && hasValues(2))
+		{
+			params.w = std::atoi(argv[++i]);
+			params.h = std::atoi(argv[++i]);
+		}
+		else if (arg == "--center" && hasValues(2))
+		{
+			centerX = argv[++i];
+			centerY = argv[++i];
+		}
+		else if (arg == "--zoom" && hasValues(1))
+		{
+			params.zoom = std::atof(argv[++i]);
+		}
+		else if (arg == "--perturbation")
+		{
+			perturbation = true;
+		}
+		else if (arg == "--no-series")
+		{
+			series = false;
+		}
+		else if (arg == "--no-periodicity")
+		{
+			params.periodicity = false;
+		}
+		else if (arg == "--show-periods")
+		{
+			params.showPeriods = true;
+		}
+		else if (arg == "--subdivide")
+		{
+			subdivide = true;
+		}
+		else if (arg == "--iterations" && hasValues(1))
+		{
+			params.maxIterations = std::atoi(argv[++i]);
+		}
+		else if (arg == "--base-iterations" && hasValues(1))
+		{
+			params.baseIterations = std::atoi(argv[++i]);
+		}
+		else if (arg == "--julia" && hasValues(2))
+		{
+			params.juliaCx = std::atof(argv[++i]);
+			params.juliaCy = std::atof(argv[++i]);
+		}
+		else if (arg == "--color" && hasValues(2))
+		{
+			params.saturation = static_cast<float>(std::atof(argv[++i]));
+			params.brightness = static_cast<float>(std::atof(argv[++i]));
+		}
+		else if (arg == "--threads" && hasValues(1))
+		{
+			threads = static_cast<unsigned int>(std::atoi(argv[++i]));
+		}
+		else if (arg == "--isa" && hasValues(1))
+		{
+			if (!parseSimdIsa(argv[++i], isa))
+			{
+				std::cout << "Unknown instruction set: " << argv[i] << std::endl;
+				return -1;
+			}
+			if (!isSimdIsaSupported(isa))
+			{
+				std::cout << argv[i] << " is not supported on this CPU, using " << getEscapeKernels(isa).name << std::endl;
+			}
+		}
+		else if (arg == "--float")
+		{
+			singlePrecision = true;
+		}
+		else if (arg == "--frames" && hasValues(1))
+		{
+			frames = std::atoi(argv[++i]);
+		}
+		else if (arg == "--zoom-step" && hasValues(1))
+		{
+			zoomStep = std::atof(argv[++i]);
+		}
+		else
+		{
+			printHeadlessUsage();
+			return arg == "--help" ? 0 : -1;
+		}
+	}
+
+	if (params.w <= 0 || params.h <= 0 || params.maxIterations <= 0 || params.baseIterations <= 0 || frames <= 0 || !(params.zoom > 0.0) || params.zoom > maxZoom || zoomStep < 0.0)
+	{
+		std::cout << "Invalid headless parameters" << std::endl;
+		return -1;
+	}
+
+	// The center is parsed at full precision, so deep zoom coordinates can be passed as long decimals
+	double finalZoom = zoomStep > 0.0 ? std::min(params.zoom * std::pow(zoomStep, frames - 1), maxZoom) : params.zoom;
+	int centerBits = BigFixed::bitsForZoom(std::max(params.zoom, finalZoom));
+	if (!BigFixed::fromString(centerX, centerBits, params.cx) || !BigFixed::fromString(centerY, centerBits, params.cy))
+	{
+		std::cout << "Invalid center: " << centerX << " " << centerY << std::endl;
+		return -1;
+	}
+
+	CpuRenderer renderer(threads);
+	renderer.setKernels(getEscapeKernels(isa));
+	renderer.setSinglePrecision(singlePrecision);
+	renderer.setPerturbation(perturbation);
+	renderer.setSeriesApproximation(series);
+	renderer.setSubdivision(subdivide);
+	std::vector<uint8_t> rgba;
+	std::cout << "Rendering " << params.w << "x" << params.h << " on " << renderer.getThreadCount() << " threads (";
+	if (perturbation || CpuRenderer::needsPerturbation(params))
+	{
+		std::cout << "perturbation, " << centerBits << " bit reference)" << std::endl;
+	}
+	else
+	{
+		std::cout << renderer.getKernels().name << ", " << (singlePrecision ? "float" : "double") << ")" << std::endl;
+	}
+
+	double totalMs = 0.0;
+	for (int frame = 0; frame < frames; frame++)
+	{
+		auto start = std::chrono::steady_clock::now();
+		double iterated = 1.0;
+		if (zoomStep > 0.0)
+		{
+			if (frame > 0) params.zoom = std::min(params.zoom * zoomStep, maxZoom);
+			iterated = renderer.renderZoom(params, rgba);
+		}
+		else
+		{
+			renderer.render(params, rgba);
+		}
+		double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		totalMs += ms;
+		std::cout << "Frame " << frame << ": " << ms << " ms";
+		if (zoomStep > 0.0)
+		{
+			std::cout << ", iterated " << iterated * 100.0 << "% of the pixels";
+		}
+		std::cout << std::endl;
+	}
+	if (renderer.getSkippedIterations() > 0)
+	{
+		std::cout << "Series approximation skipped " << renderer.getSkippedIterations() << " iterations" << std::endl;
+	}
+	if (frames > 1)
+	{
+		std::cout << "Average: " << totalMs / frames << " ms" << std::endl;
+	}
+
+	return FileUtils::writePPM(output, params.w, params.h, rgba) ? 0 : -1;
+}
@@ -0,0 +1,82 @@
+#include <IterationLimit.h>
+
+#include <algorithm>
+#include <cmath>
+
+// Share of the escaped samples allowed past the tail
+static constexpr double tailFraction = 0.001;
+// Share of unescaped samples below which the limit is never raised
+static constexpr double unescapedFraction = 0.001;
+// Part of the unescaped share that has to be left after a raise for the next one
+static constexpr double raiseGain = 0.75;
+// Bounds of the U_MAX_ITERATIONS slider, with a floor that keeps shallow views detailed
+static constexpr int minIterationLimit = 64;
+static constexpr int maxIterationLimit = 1000000;
+
+EscapeStatistics gatherEscapeStatistics(const std::vector<float>& centers, int maxIterations)
+{
+	EscapeStatistics statistics;
+	statistics.maxIterations = maxIterations;
+	std::vector<float> escaped;
+	escaped.reserve(centers.size() / 4);
+	for (size_t i = 0; i + 3 < centers.size(); i += 4)
+	{
+		statistics.samples++;
+		if (centers[i] < static_cast<float>(maxIterations))
+		{
+			escaped.push_back(centers[i]);
+		}
+		else if (centers[i + 3] <= 0.0f)
+		{
+			statistics.unescaped++;
+		}
+	}
+	if (!escaped.empty())
+	{
+		size_t rank = std::min(escaped.size() - 1, static_cast<size_t>(escaped.size() * (1.0 - tailFraction)));
+		std::nth_element(escaped.begin(), escaped.begin() + rank, escaped.end());
+		statistics.tail = static_cast<int>(escaped[rank]);
+	}
+	return statistics;
+}
+
+static int nextPowerOfTwo(int n)
+{
+	int power = 1;
+	while (power < n) power *= 2;
+	return power;
+}
+
+static double unescapedShare(const EscapeStatistics& statistics)
+{
+	return static_cast<double>(statistics.unescaped) / statistics.samples;
+}
+
+int chooseIterationLimit(const EscapeStatistics& statistics, const EscapeStatistics& raisedFrom)
+{
+	int limit = statistics.maxIterations;
+	// Without escapes there's no tail to fit. With perturbation or periodicity off the interior
+	// never settles into a cycle, so it would count as unescaped and double the limit up to the
+	// maximum.
+	if (statistics.samples == 0 || statistics.tail == 0) return limit;
+	if (unescapedShare(statistics) > unescapedFraction)
+	{
+		// Escapes reaching into the upper half of the range mean the distribution goes on past the
+		// limit, the unescaped samples are likely part of it rather than the interior
+		bool crowded = statistics.tail > limit / 2;
+		// Otherwise only the last raise tells, if it didn't shrink the unescaped share they're interior
+		bool helped = raisedFrom.samples > 0 && raisedFrom.maxIterations * 2 == limit
+			&& unescapedShare(statistics) < unescapedShare(raisedFrom) * raiseGain;
+		if (crowded || helped)
+		{
+			return std::min(maxIterationLimit, limit * 2);
+		}
+	}
+	// Lowering restarts the frame, so it waits until it saves most of the iterations
+	int needed = std::max(minIterationLimit, nextPowerOfTwo(statistics.tail * 2));
+	if (needed <= limit / 4)
+	{
+		return needed;
+	}
+	return limit;
+}
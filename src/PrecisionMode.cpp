@@ -0,0 +1,48 @@
+#include <PrecisionMode.h>
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+static constexpr int precisionMarginBits = 4;
+
+const char* getPrecisionModeName(PrecisionMode mode)
+{
+	switch (mode)
+	{
+	case PrecisionMode::Float: return "Float";
+	case PrecisionMode::DoubleSingle: return "Double-Single";
+	case PrecisionMode::Double: return "Double";
+	case PrecisionMode::Perturbation: return "Perturbation";
+	}
+	return "";
+}
+
+int getPrecisionModeBits(PrecisionMode mode)
+{
+	switch (mode)
+	{
+	case PrecisionMode::Float: return 24;
+	case PrecisionMode::DoubleSingle: return 48;
+	case PrecisionMode::Double: return 53;
+	case PrecisionMode::Perturbation: return INT_MAX;
+	}
+	return 0;
+}
+
+int requiredPrecisionBits(const FractalParams& params)
+{
+	// The view is 8 / zoom high, while iterated values grow up to the escape radius of 2
+	double spacing = 8.0 / (params.zoom * params.h);
+	double magnitude = std::max({std::fabs(params.cx.toDouble()), std::fabs(params.cy.toDouble()), 2.0});
+	return static_cast<int>(std::ceil(std::log2(magnitude / spacing))) + precisionMarginBits;
+}
+
+PrecisionMode choosePrecisionMode(const FractalParams& params, bool hasFp64)
+{
+	int bits = requiredPrecisionBits(params);
+	if (bits <= getPrecisionModeBits(PrecisionMode::Float)) return PrecisionMode::Float;
+	PrecisionMode doubleMode = hasFp64 ? PrecisionMode::Double : PrecisionMode::DoubleSingle;
+	if (bits <= getPrecisionModeBits(doubleMode)) return doubleMode;
+	return PrecisionMode::Perturbation;
+}
@@ -0,0 +1,128 @@
+#include <ProgramCache.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <vector>
+
+// FNV-1a over the string and its null terminator, so where one string ends is part of the hash
+static uint64_t hashString(uint64_t hash, const char* data, size_t size)
+{
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= static_cast<unsigned char>(data[i]);
+		hash *= 0x100000001b3ull;
+	}
+	return hash * 0x100000001b3ull;
+}
+
+uint64_t ProgramCache::getKey(const std::vector<std::string>& sources)
+{
+	uint64_t hash = 0xcbf29ce484222325ull;
+	for (GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION})
+	{
+		const char* value = reinterpret_cast<const char*>(glGetString(name));
+		if (value) hash = hashString(hash, value, std::char_traits<char>::length(value));
+	}
+	for (const std::string& source : sources)
+	{
+		hash = hashString(hash, source.data(), source.size());
+	}
+	return hash;
+}
+
+// The platform's per-user cache directory
+std::string ProgramCache::getDirectory()
+{
+	const char* base = std::getenv("XDG_CACHE_HOME");
+	std::string directory;
+	if (base && *base)
+	{
+		directory = base;
+	}
+	else if ((base = std::getenv("LOCALAPPDATA")))
+	{
+		directory = base;
+	}
+	else if ((base = std::getenv("HOME")))
+	{
+		directory = std::string(base) + "/.cache";
+	}
+	else
+	{
+		return "";
+	}
+	return directory + "/FractalDive/programs";
+}
+
+std::string ProgramCache::getPath(uint64_t key)
+{
+	std::string directory = getDirectory();
+	if (directory.empty()) return "";
+	char name[21];
+	std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+	return directory + "/" + name;
+}
+
+bool ProgramCache::load(GLuint program, uint64_t key)
+{
+	GLint formats = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+	std::string path = getPath(key);
+	if (formats == 0 || path.empty()) return false;
+	std::ifstream file(path, std::ios::binary);
+	if (!file.is_open()) return false;
+
+	// The binary format followed by the binary itself
+	GLenum format = 0;
+	file.read(reinterpret_cast<char*>(&format), sizeof(format));
+	std::vector<char> binary((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	if (!file.eof() || binary.empty()) return false;
+	glProgramBinary(program, format, binary.data(), static_cast<GLsizei>(binary.size()));
+
+	// Drivers reject binaries they can't use anymore, the caller compiles from source then
+	GLint linked = GL_FALSE;
+	glGetProgramiv(program, GL_LINK_STATUS, &linked);
+	return linked == GL_TRUE;
+}
+
+void ProgramCache::store(GLuint program, uint64_t key)
+{
+	GLint formats = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+	std::string path = getPath(key);
+	if (formats == 0 || path.empty()) return;
+
+	GLint length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0) return;
+	std::vector<char> binary(length);
+	GLenum format = 0;
+	glGetProgramBinary(program, length, &length, &format, binary.data());
+
+	std::error_code error;
+	std::filesystem::create_directories(getDirectory(), error);
+	// Written under a unique name and renamed into place, so other instances never read half a file
+	std::string temporary = path + "." + std::to_string(std::random_device()()) + ".tmp";
+	{
+		std::ofstream file(temporary, std::ios::binary);
+		file.write(reinterpret_cast<const char*>(&format), sizeof(format));
+		file.write(binary.data(), length);
+		if (!file.good())
+		{
+			std::cout << "Failed to write program cache " << temporary << std::endl;
+			file.close();
+			std::filesystem::remove(temporary, error);
+			return;
+		}
+	}
+	std::filesystem::rename(temporary, path, error);
+	if (error)
+	{
+		std::filesystem::remove(temporary, error);
+	}
+}
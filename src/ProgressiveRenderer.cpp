@@ -0,0 +1,557 @@
+#include <ProgressiveRenderer.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+
+// Block size of each pass, 0 is the anti-aliasing pass
+static const int passSteps[] = {4, 2, 1, 0};
+static constexpr int fullResolutionPass = 2;
+static constexpr int antiAliasingPass = 3;
+// Share of the pixels each pass up to the full resolution one computes the center of
+static const double passShares[] = {1.0 / 16, 3.0 / 16, 12.0 / 16};
+// The pool fits a quarter of the pixels at the full rate, edges past that keep their center
+static constexpr int poolFraction = 4;
+// local_size_x of escape.comp
+static constexpr int computeGroupSize = 64;
+
+ProgressiveRenderer::ProgressiveRenderer()
+{
+	glGenQueries(1, &timerQuery);
+}
+
+ProgressiveRenderer::~ProgressiveRenderer()
+{
+	release();
+	glDeleteQueries(1, &timerQuery);
+}
+
+void ProgressiveRenderer::release()
+{
+	glDeleteFramebuffers(1, &centerFramebuffer);
+	glDeleteFramebuffers(1, &rangeFramebuffer);
+	glDeleteTextures(1, &centers);
+	glDeleteTextures(1, &sampleRanges);
+	glDeleteBuffers(1, &samplePool);
+	glDeleteBuffers(1, &edgeList);
+	glDeleteBuffers(1, &iterationStates);
+	glDeleteFramebuffers(1, &jitterFramebuffer);
+	glDeleteFramebuffers(1, &historyFramebuffer);
+	glDeleteTextures(1, &jitterSamples);
+	glDeleteTextures(1, &history);
+	glDeleteFramebuffers(1, &sampleFramebuffer);
+	glDeleteTextures(1, &centerSamples);
+	centerFramebuffer = rangeFramebuffer = centers = sampleRanges = samplePool = edgeList = iterationStates = 0;
+	jitterFramebuffer = historyFramebuffer = jitterSamples = history = 0;
+	sampleFramebuffer = centerSamples = 0;
+	sampleWidth = sampleHeight = 0;
+	poolGrid = 0;
+}
+
+// The fractal shaders write the centers to output 0 and the sample ranges to output 1
+static GLuint createFramebuffer(GLuint texture, int output)
+{
+	GLuint framebuffer;
+	glGenFramebuffers(1, &framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + output, GL_TEXTURE_2D, texture, 0);
+	GLenum attachments[] = {GL_NONE, GL_NONE};
+	attachments[output] = GL_COLOR_ATTACHMENT0 + output;
+	glDrawBuffers(2, attachments);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cout << "Progressive render target is incomplete" << std::endl;
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	return framebuffer;
+}
+
+static GLuint createTexture(int w, int h, GLenum internalFormat, GLenum format, GLenum type)
+{
+	GLuint texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, w, h, 0, format, type, nullptr);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	return texture;
+}
+
+void ProgressiveRenderer::resize(int width, int height)
+{
+	if (width == w && height == h) return;
+	release();
+	w = width;
+	h = height;
+
+	centers = createTexture(w, h, GL_RGBA32F, GL_RGBA, GL_FLOAT);
+	sampleRanges = createTexture(w, h, GL_RG32I, GL_RG_INTEGER, GL_INT);
+	centerFramebuffer = createFramebuffer(centers, 0);
+	rangeFramebuffer = createFramebuffer(sampleRanges, 1);
+	jitterSamples = createTexture(w, h, GL_RGBA32F, GL_RGBA, GL_FLOAT);
+	history = createTexture(w, h, GL_RGBA32F, GL_RGBA, GL_FLOAT);
+	jitterFramebuffer = createFramebuffer(jitterSamples, 0);
+	historyFramebuffer = createFramebuffer(history, 0);
+	glGenBuffers(1, &samplePool);
+	// Whole passes list the edges of the full image, four header words then a word per pixel
+	glGenBuffers(1, &edgeList);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, edgeList);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, (4 + static_cast<size_t>(w) * h) * sizeof(GLuint), nullptr, GL_DYNAMIC_DRAW);
+	glGenBuffers(1, &iterationStates);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, iterationStates);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<size_t>(w) * h * 4 * sizeof(GLuint), nullptr, GL_DYNAMIC_DRAW);
+	restart();
+}
+
+// Sized for the current grid, a header of the used and total sample counts followed by vec2 samples.
+// Capped to the largest storage block the driver binds, and halved while the allocation fails.
+void ProgressiveRenderer::allocatePool()
+{
+	GLuint header[] = {0, 0};
+	const GLint64 sampleSize = 2 * sizeof(float);
+	GLint64 maxBlockSize = 0;
+	glGetInteger64v(GL_MAX_SHADER_STORAGE_BLOCK_SIZE, &maxBlockSize);
+	GLint64 wanted = static_cast<GLint64>(w) * h * std::max(1, maxGrid * maxGrid / poolFraction);
+	GLint64 capacity = std::max<GLint64>(0, std::min(wanted, (maxBlockSize - static_cast<GLint64>(sizeof(header))) / sampleSize));
+	capacity = std::min<GLint64>(capacity, UINT32_MAX);
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, samplePool);
+	while (glGetError() != GL_NO_ERROR) {}
+	bool allocated = false;
+	while (true)
+	{
+		glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(header) + capacity * sampleSize, nullptr, GL_DYNAMIC_DRAW);
+		allocated = glGetError() == GL_NO_ERROR;
+		if (allocated || capacity == 0) break;
+		capacity /= 2;
+	}
+	if (!allocated)
+	{
+		std::cout << "Sample pool allocation failed" << std::endl;
+		return;
+	}
+	if (capacity < wanted)
+	{
+		std::cout << "Sample pool limited to " << capacity << " of " << wanted << " samples" << std::endl;
+	}
+	// Edges past the capacity keep their center
+	header[1] = static_cast<GLuint>(capacity);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(header), header);
+	poolGrid = maxGrid;
+}
+
+void ProgressiveRenderer::setSupersampling(int grid, float threshold)
+{
+	if (grid == maxGrid && threshold == edgeThreshold) return;
+	maxGrid = grid;
+	edgeThreshold = threshold;
+	if (pass >= antiAliasingPass)
+	{
+		pass = antiAliasingPass;
+		tile = 0;
+		accumulated = 0;
+	}
+}
+
+void ProgressiveRenderer::setAccumulation(int frames)
+{
+	accumulationFrames = frames;
+}
+
+void ProgressiveRenderer::restartAccumulation()
+{
+	accumulationHeld = false;
+	if (accumulated == 0 && (pass < passCount || tile == 0)) return;
+	accumulated = 0;
+	if (pass == passCount) tile = 0;
+}
+
+void ProgressiveRenderer::holdAccumulation()
+{
+	restartAccumulation();
+	accumulationHeld = true;
+}
+
+void ProgressiveRenderer::setColoring(const ColorVariant& variant)
+{
+	coloring = variant;
+}
+
+void ProgressiveRenderer::restart()
+{
+	pass = 0;
+	tile = 0;
+	accumulated = 0;
+	accumulationHeld = false;
+	refreshing = false;
+	statesValid = false;
+	resumeFrom = 0;
+}
+
+void ProgressiveRenderer::setTimeBudget(float milliseconds)
+{
+	timeBudget = milliseconds;
+}
+
+bool ProgressiveRenderer::isStarted() const
+{
+	return pass > 0 && resumeFrom == 0;
+}
+
+bool ProgressiveRenderer::hasFullResolution() const
+{
+	return pass > fullResolutionPass || refreshing;
+}
+
+double ProgressiveRenderer::getFullResolutionProgress() const
+{
+	if (pass > fullResolutionPass) return 1.0;
+	double progress = 0.0;
+	for (int i = 0; i < pass; i++)
+	{
+		progress += passShares[i];
+	}
+	return progress + passShares[pass] * tile / getTileCount();
+}
+
+bool ProgressiveRenderer::hasFullImage() const
+{
+	return pass == passCount;
+}
+
+bool ProgressiveRenderer::isComplete() const
+{
+	return pass == passCount && (accumulationHeld || accumulated >= accumulationFrames);
+}
+
+int ProgressiveRenderer::getTileCount() const
+{
+	return ((w + tileSize - 1) / tileSize) * ((h + tileSize - 1) / tileSize);
+}
+
+// Van der Corput sequence in base, the Halton sequence takes bases 2 and 3 for x and y
+static float radicalInverse(int index, int base)
+{
+	float result = 0.0f;
+	float digit = 1.0f / base;
+	for (; index > 0; index /= base, digit /= base)
+	{
+		result += (index % base) * digit;
+	}
+	return result;
+}
+
+std::vector<ProgressiveRenderer::Region> ProgressiveRenderer::getTiles(int first, int last) const
+{
+	if (first == 0 && last == getTileCount()) return {{0, 0, w, h}};
+	std::vector<Region> tiles;
+	int columns = (w + tileSize - 1) / tileSize;
+	for (int t = first; t < last; t++)
+	{
+		tiles.push_back({(t % columns) * tileSize, (t / columns) * tileSize, tileSize, tileSize});
+	}
+	return tiles;
+}
+
+void ProgressiveRenderer::drawRegions(FractalProgram& program, const std::vector<Region>& regions, bool first)
+{
+	bool accumulating = pass == passCount;
+	Shader& shader = program.shader;
+	shader.use();
+	shader.set(program.step, accumulating ? -1 : passSteps[pass]);
+	shader.set(program.prevStep, pass > 0 && !refreshing && resumeFrom == 0 ? passSteps[pass - 1] : 0);
+	shader.set(program.resumeFrom, resumeFrom);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, iterationStates);
+	if (accumulating)
+	{
+		if (accumulated == 0 && first)
+		{
+			// The history starts out as the anti-aliased image, counted as one frame
+			const GLfloat zero[] = {0.0f, 0.0f, 0.0f, 0.0f};
+			glBindFramebuffer(GL_FRAMEBUFFER, historyFramebuffer);
+			glClearBufferfv(GL_COLOR, 0, zero);
+			glEnable(GL_BLEND);
+			glBlendFunc(GL_ONE, GL_ONE);
+			drawColors(centers, 0);
+			glDisable(GL_BLEND);
+			shader.use();
+		}
+		// Halton points skip index 0, the pixel center the passes already took
+		shader.set(program.jitter, radicalInverse(accumulated + 1, 2) - 0.5f, radicalInverse(accumulated + 1, 3) - 0.5f);
+	}
+	else if (pass == antiAliasingPass)
+	{
+		if (first)
+		{
+			// Empties the pool, reallocating it when the grid grew or shrank
+			if (poolGrid != maxGrid)
+			{
+				allocatePool();
+			}
+			GLuint used = 0;
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, samplePool);
+			glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(used), &used);
+		}
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, samplePool);
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, centers);
+		shader.set(program.edgeThreshold, edgeThreshold);
+	}
+	else if (resumeFrom > 0)
+	{
+		// The centers as they were before, the pass overwrites them
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, jitterSamples);
+	}
+	if (program.compute)
+	{
+		dispatchRegions(program, regions);
+	}
+	else
+	{
+		if (accumulating)
+		{
+			glBindFramebuffer(GL_FRAMEBUFFER, jitterFramebuffer);
+		}
+		else
+		{
+			glBindFramebuffer(GL_FRAMEBUFFER, pass == antiAliasingPass ? rangeFramebuffer : centerFramebuffer);
+		}
+		if (regions.size() == 1 && regions[0].width >= w && regions[0].height >= h)
+		{
+			glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr);
+		}
+		else
+		{
+			glEnable(GL_SCISSOR_TEST);
+			for (const Region& region : regions)
+			{
+				glScissor(region.x, region.y, region.width, region.height);
+				glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr);
+			}
+			glDisable(GL_SCISSOR_TEST);
+		}
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	}
+	if (resumeFrom > 0)
+	{
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
+	if (pass == antiAliasingPass)
+	{
+		glBindTexture(GL_TEXTURE_2D, 0);
+		// The color pass reads the samples back from the pool
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+	}
+}
+
+void ProgressiveRenderer::dispatchRegions(FractalProgram& program, const std::vector<Region>& regions)
+{
+	bool accumulating = pass == passCount;
+	int step = accumulating ? 1 : std::max(passSteps[pass], 1);
+	const Shader& shader = program.shader;
+	glBindImageTexture(0, accumulating ? jitterSamples : centers, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32F);
+	glBindImageTexture(1, sampleRanges, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RG32I);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, edgeList);
+
+	for (const Region& region : regions)
+	{
+		int blocksX = (std::min(region.width, w - region.x) + step - 1) / step;
+		int blocksY = (std::min(region.height, h - region.y) + step - 1) / step;
+		GLuint groups = static_cast<GLuint>((blocksX * blocksY + computeGroupSize - 1) / computeGroupSize);
+		shader.set(program.tileOrigin, region.x, region.y);
+		shader.set(program.tileBlocks, blocksX, blocksY);
+		if (accumulating || pass != antiAliasingPass)
+		{
+			glDispatchCompute(groups, 1, 1);
+			continue;
+		}
+		// Lists the region's edges along with the workgroup count they need, then supersamples
+		// only those through an indirect dispatch
+		const GLuint header[] = {0, 1, 1, 0};
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, edgeList);
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(header), header);
+		shader.set(program.edgeStage, 0);
+		glDispatchCompute(groups, 1, 1);
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+		shader.set(program.edgeStage, 1);
+		glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, edgeList);
+		glDispatchComputeIndirect(0);
+		glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, 0);
+	}
+	// Later passes and the color pass read the images through samplers
+	glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+}
+
+bool ProgressiveRenderer::shift(FractalProgram& program, int dx, int dy)
+{
+	if (!hasFullResolution() || std::abs(dx) >= w || std::abs(dy) >= h) return false;
+	// Copies within a texture mustn't overlap, so the part that stays goes through the jittered
+	// samples, which the accumulation restarting anyway leaves unused
+	int width = w - std::abs(dx);
+	int height = h - std::abs(dy);
+	// Image stores of the compute path have to land before the copy reads them
+	glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT);
+	glCopyImageSubData(centers, GL_TEXTURE_2D, 0, std::max(-dx, 0), std::max(-dy, 0), 0,
+		jitterSamples, GL_TEXTURE_2D, 0, 0, 0, 0, width, height, 1);
+	glCopyImageSubData(jitterSamples, GL_TEXTURE_2D, 0, 0, 0, 0,
+		centers, GL_TEXTURE_2D, 0, std::max(dx, 0), std::max(dy, 0), 0, width, height, 1);
+
+	// The full resolution pass computes the exposed strips now and refreshes the rest later
+	pass = fullResolutionPass;
+	tile = 0;
+	accumulated = 0;
+	refreshing = true;
+	statesValid = false;
+	std::vector<Region> strips;
+	if (dx != 0)
+	{
+		strips.push_back({dx > 0 ? 0 : w + dx, 0, std::abs(dx), h});
+	}
+	if (dy != 0)
+	{
+		strips.push_back({std::max(dx, 0), dy > 0 ? 0 : h + dy, width, std::abs(dy)});
+	}
+	drawRegions(program, strips, false);
+	return true;
+}
+
+bool ProgressiveRenderer::resume(int previousIterations)
+{
+	if (pass <= fullResolutionPass || !statesValid) return false;
+	// The pass reads the previous centers from a copy in the jittered samples, which the
+	// accumulation restarting anyway leaves unused
+	glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+	glCopyImageSubData(centers, GL_TEXTURE_2D, 0, 0, 0, 0, jitterSamples, GL_TEXTURE_2D, 0, 0, 0, 0, w, h, 1);
+	pass = fullResolutionPass;
+	tile = 0;
+	accumulated = 0;
+	resumeFrom = previousIterations;
+	return true;
+}
+
+void ProgressiveRenderer::finishPass()
+{
+	tile = 0;
+	if (pass < passCount)
+	{
+		if (pass == fullResolutionPass)
+		{
+			statesValid = true;
+			refreshing = false;
+			resumeFrom = 0;
+		}
+		pass++;
+		return;
+	}
+	// Adds the colors of the jittered frame to the history, alpha counts the frames
+	glBindFramebuffer(GL_FRAMEBUFFER, historyFramebuffer);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_ONE, GL_ONE);
+	drawColors(jitterSamples, 1);
+	glDisable(GL_BLEND);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	accumulated++;
+}
+
+bool ProgressiveRenderer::readCenters(int width, int height, std::vector<float>& samples)
+{
+	if (pass <= fullResolutionPass) return false;
+	width = std::min(width, w);
+	height = std::min(height, h);
+	if (width != sampleWidth || height != sampleHeight)
+	{
+		glDeleteFramebuffers(1, &sampleFramebuffer);
+		glDeleteTextures(1, &centerSamples);
+		centerSamples = createTexture(width, height, GL_RGBA32F, GL_RGBA, GL_FLOAT);
+		sampleFramebuffer = createFramebuffer(centerSamples, 0);
+		sampleWidth = width;
+		sampleHeight = height;
+	}
+	// Compute passes store the centers as images
+	glMemoryBarrier(GL_FRAMEBUFFER_BARRIER_BIT);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, centerFramebuffer);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, sampleFramebuffer);
+	glBlitFramebuffer(0, 0, w, h, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, sampleFramebuffer);
+	samples.resize(static_cast<size_t>(width) * height * 4);
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_FLOAT, samples.data());
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	return true;
+}
+
+void ProgressiveRenderer::renderPass(FractalProgram& program)
+{
+	if (isComplete()) return;
+	drawRegions(program, getTiles(tile, getTileCount()), tile == 0);
+	finishPass();
+}
+
+// The previous slice has finished by the time the next one starts, so this doesn't stall
+void ProgressiveRenderer::readTimerQuery()
+{
+	if (timedTiles == 0) return;
+	GLuint64 elapsed = 0;
+	glGetQueryObjectui64v(timerQuery, GL_QUERY_RESULT, &elapsed);
+	tileCost[timedPass] = elapsed * 1e-6 / timedTiles;
+	timedTiles = 0;
+}
+
+bool ProgressiveRenderer::renderSlice(FractalProgram& program)
+{
+	if (isComplete()) return false;
+	if (timeBudget <= 0.0f)
+	{
+		renderPass(program);
+		return true;
+	}
+	readTimerQuery();
+	// A pass that was never measured starts with a single tile
+	int tiles = tileCost[pass] > 0.0 ? std::max(1, static_cast<int>(timeBudget / tileCost[pass])) : 1;
+	int last = std::min(tile + tiles, getTileCount());
+	glBeginQuery(GL_TIME_ELAPSED, timerQuery);
+	drawRegions(program, getTiles(tile, last), tile == 0);
+	glEndQuery(GL_TIME_ELAPSED);
+	timedPass = pass;
+	timedTiles = last - tile;
+	tile = last;
+	if (tile < getTileCount()) return false;
+	finishPass();
+	return true;
+}
+
+void ProgressiveRenderer::drawColors(GLuint centerTexture, int step)
+{
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, centerTexture);
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D, sampleRanges);
+	glActiveTexture(GL_TEXTURE2);
+	glBindTexture(GL_TEXTURE_2D, history);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, samplePool);
+	ColorProgram& colorProgram = colorPrograms.get(coloring);
+	colorProgram.shader.use();
+	colorProgram.shader.set(colorProgram.step, step);
+	glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void ProgressiveRenderer::present()
+{
+	if (!isStarted()) return;
+	// -1 resolves the history
+	if (hasFullImage() && accumulated > 0)
+	{
+		drawColors(centers, -1);
+	}
+	else
+	{
+		drawColors(centers, refreshing ? 1 : passSteps[pass - 1]);
+	}
+}
\ No newline at end of file
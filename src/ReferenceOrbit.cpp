@@ -0,0 +1,107 @@
+#include <ReferenceOrbit.h>
+
+#include <cmath>
+
+void ReferenceOrbit::iterate(const BigFixed& startX, const BigFixed& startY, const BigFixed& cx, const BigFixed& cy,
+	int maxIterations, std::vector<double>& outX, std::vector<double>& outY)
+{
+	outX.clear();
+	outY.clear();
+	BigFixed zx = startX, zy = startY;
+	for (int n = 0; n <= maxIterations; n++)
+	{
+		double x = zx.toDouble(), y = zy.toDouble();
+		outX.push_back(x);
+		outY.push_back(y);
+		if (x * x + y * y >= 4.0) break;
+
+		BigFixed xy = zx * zy;
+		zx = zx * zx - zy * zy + cx;
+		zy = xy + xy + cy;
+	}
+}
+
+bool ReferenceOrbit::isValidFor(const FractalParams& params) const
+{
+	if (orbitX.empty() || params.isJulia() != julia) return false;
+	if (julia && (params.juliaCx != juliaCx || params.juliaCy != juliaCy)) return false;
+	if (fractionBits < BigFixed::bitsForZoom(params.zoom)) return false;
+
+	// An orbit that escaped early is complete for any iteration limit
+	bool escaped = static_cast<int>(orbitX.size()) <= maxIterations;
+	if (!escaped && maxIterations < params.maxIterations) return false;
+
+	// Keep the reference inside the view so the offsets stay small
+	double aspectRatio = static_cast<double>(params.w) / params.h;
+	return std::fabs(offsetX(params)) <= 4.0 * aspectRatio / params.zoom && std::fabs(offsetY(params)) <= 4.0 / params.zoom;
+}
+
+bool ReferenceOrbit::update(const FractalParams& params)
+{
+	if (isValidFor(params)) return false;
+	compute(params);
+	return true;
+}
+
+void ReferenceOrbit::compute(const FractalParams& params)
+{
+	julia = params.isJulia();
+	juliaCx = julia ? params.juliaCx : 0.0;
+	juliaCy = julia ? params.juliaCy : 0.0;
+	maxIterations = params.maxIterations;
+	fractionBits = BigFixed::bitsForZoom(params.zoom);
+
+	refX = params.cx;
+	refY = params.cy;
+	refX.setFractionBits(fractionBits);
+	refY.setFractionBits(fractionBits);
+	BigFixed zero(0.0, fractionBits);
+
+	if (julia)
+	{
+		BigFixed cx(juliaCx, fractionBits), cy(juliaCy, fractionBits);
+		iterate(refX, refY, cx, cy, maxIterations, orbitX, orbitY);
+		iterate(zero, zero, cx, cy, maxIterations, criticalX, criticalY);
+	}
+	else
+	{
+		iterate(zero, zero, refX, refY, maxIterations, orbitX, orbitY);
+		criticalX.clear();
+		criticalY.clear();
+	}
+}
+
+double ReferenceOrbit::offsetX(const FractalParams& params) const
+{
+	return (params.cx - refX).toDouble();
+}
+
+double ReferenceOrbit::offsetY(const FractalParams& params) const
+{
+	return (params.cy - refY).toDouble();
+}
+
+bool ReferenceOrbit::isJulia() const
+{
+	return julia;
+}
+
+const std::vector<double>& ReferenceOrbit::getX() const
+{
+	return orbitX;
+}
+
+const std::vector<double>& ReferenceOrbit::getY() const
+{
+	return orbitY;
+}
+
+const std::vector<double>& ReferenceOrbit::getCriticalX() const
+{
+	return julia ? criticalX : orbitX;
+}
+
+const std::vector<double>& ReferenceOrbit::getCriticalY() const
+{
+	return julia ? criticalY : orbitY;
+}
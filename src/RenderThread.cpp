@@ -0,0 +1,487 @@
+#include <RenderThread.h>
+
+#include <FractalProgram.h>
+#include <IterationLimit.h>
+#include <ParameterBlocks.h>
+#include <ProgressiveRenderer.h>
+#include <ReferenceOrbit.h>
+#include <SeriesApproximation.h>
+#include <UniformBuffer.h>
+#include <VariantCache.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include <memory>
+#include <vector>
+
+// The shader iterates in float, so the orbit is narrowed and interleaved as vec2
+static void uploadReferenceOrbit(const ReferenceOrbit& orbit, const GLuint buffers[2])
+{
+	const std::vector<double>* orbits[2][2] = {
+		{&orbit.getX(), &orbit.getY()},
+		{&orbit.getCriticalX(), &orbit.getCriticalY()}
+	};
+	std::vector<float> data;
+	for (int i = 0; i < 2; i++)
+	{
+		const std::vector<double>& x = *orbits[i][0];
+		const std::vector<double>& y = *orbits[i][1];
+		data.resize(x.size() * 2);
+		for (size_t n = 0; n < x.size(); n++)
+		{
+			data[n * 2] = static_cast<float>(x[n]);
+			data[n * 2 + 1] = static_cast<float>(y[n]);
+		}
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffers[i]);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, data.size() * sizeof(float), data.data(), GL_DYNAMIC_DRAW);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, i, buffers[i]);
+	}
+}
+
+// Side of the grid of centers the iteration limit is chosen from
+static constexpr int statisticsGrid = 128;
+
+// Seconds without a color change before accumulation starts again
+static constexpr double colorSettleTime = 0.25;
+
+// MAX_SERIES_TERMS of perturbation.frag
+static constexpr int maxSeriesTerms = 16;
+
+// u_deltaExponent of perturbation.frag. Views whose pixels are far enough above float's normal
+// range keep 0, which iterates plain floats, deeper ones are scaled to about 1.
+static int getDeltaExponent(const FractalParams& params)
+{
+	if (params.getPixelSize() >= std::ldexp(1.0, -100)) return 0;
+	return std::ilogb(4.0 / params.zoom);
+}
+
+// The radius is scaled like the view's offsets, the coefficients by their own exponent, as the
+// offsets have grown over the skipped iterations
+static void setSeriesUniforms(const FractalProgram& program, const SeriesApproximation& series, int deltaExponent)
+{
+	int terms = std::min(series.getTerms(), maxSeriesTerms);
+	// Pixels are at most about a radius away from the reference, so the sum bounds their offsets
+	double bound = 0.0;
+	for (int k = 0; k < terms; k++)
+	{
+		bound += std::fabs(series.getCoefficientsX()[k]) + std::fabs(series.getCoefficientsY()[k]);
+	}
+	int exponent = deltaExponent == 0 || bound == 0.0 ? deltaExponent : std::min(std::ilogb(bound), 0);
+	float coefficients[maxSeriesTerms * 2];
+	for (int k = 0; k < terms; k++)
+	{
+		coefficients[k * 2] = static_cast<float>(std::ldexp(series.getCoefficientsX()[k], -exponent));
+		coefficients[k * 2 + 1] = static_cast<float>(std::ldexp(series.getCoefficientsY()[k], -exponent));
+	}
+	const Shader& shader = program.shader;
+	shader.set(program.skipIterations, series.getSkipIterations());
+	shader.set(program.seriesTerms, terms);
+	shader.set(program.seriesExponent, exponent);
+	shader.set(program.seriesRadius, static_cast<float>(std::ldexp(series.getRadius(), -deltaExponent)));
+	shader.set(program.series, terms, coefficients);
+}
+
+// Options compiled into the fractal program rather than passed as uniforms
+static FractalVariant getVariant(const RenderSnapshot& snapshot)
+{
+	FractalVariant variant;
+	variant.precision = snapshot.precision;
+	variant.julia = snapshot.params.isJulia();
+	// Perturbation has no cycle detection, one variant covers both settings
+	variant.periodicity = snapshot.params.periodicity && snapshot.precision != PrecisionMode::Perturbation;
+	variant.maxGrid = snapshot.maxGrid;
+	variant.compute = snapshot.compute;
+	return variant;
+}
+
+RenderThread::RenderThread(GLFWwindow* context)
+	: context(context)
+{
+}
+
+RenderThread::~RenderThread()
+{
+	stop();
+}
+
+void RenderThread::start()
+{
+	running = true;
+	thread = std::thread(&RenderThread::run, this);
+}
+
+void RenderThread::stop()
+{
+	if (!thread.joinable()) return;
+	{
+		std::lock_guard<std::mutex> lock(wakeMutex);
+		running = false;
+	}
+	wake.notify_one();
+	thread.join();
+	delete mailbox.exchange(nullptr);
+	delete spare.exchange(nullptr);
+	glDeleteFramebuffers(1, &readFramebuffer);
+	readFramebuffer = 0;
+}
+
+void RenderThread::publish(const RenderSnapshot& snapshot)
+{
+	RenderSnapshot* next = spare.exchange(nullptr, std::memory_order_acq_rel);
+	if (next)
+	{
+		// Assigning keeps the capacity of the limb vectors, so this doesn't allocate either
+		*next = snapshot;
+	}
+	else
+	{
+		next = new RenderSnapshot(snapshot);
+	}
+	// A snapshot the render thread hasn't taken yet is stale now
+	RenderSnapshot* stale = mailbox.exchange(next, std::memory_order_acq_rel);
+	if (stale) recycle(stale);
+	// Taking the lock orders the notification after the thread's check, so it can't miss it
+	{
+		std::lock_guard<std::mutex> lock(wakeMutex);
+	}
+	wake.notify_one();
+}
+
+void RenderThread::recycle(RenderSnapshot* snapshot)
+{
+	// Only one spare is kept, the other one goes if both threads hand one back
+	delete spare.exchange(snapshot, std::memory_order_acq_rel);
+}
+
+bool RenderThread::hasNewFrame() const
+{
+	return (middle.load(std::memory_order_acquire) & freshFrame) != 0;
+}
+
+bool RenderThread::present(int w, int h)
+{
+	if (hasNewFrame())
+	{
+		front = middle.exchange(front, std::memory_order_acq_rel) & ~freshFrame;
+	}
+	Frame& frame = frames[front];
+	if (frame.texture == 0) return false;
+
+	// Attaching the texture again also makes the other context's writes visible here
+	if (readFramebuffer == 0) glGenFramebuffers(1, &readFramebuffer);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, readFramebuffer);
+	glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, frame.texture, 0);
+	// Frames rendered at another scale are filtered, at the same size that's a plain copy
+	glBlitFramebuffer(0, 0, frame.w, frame.h, 0, 0, w, h, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+
+	if (frame.presented) glDeleteSync(frame.presented);
+	frame.presented = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	// The render thread's context can only wait on a fence that was flushed
+	glFlush();
+	return true;
+}
+
+int RenderThread::getSkippedIterations() const
+{
+	return skippedIterations.load(std::memory_order_relaxed);
+}
+
+int RenderThread::takeIterationLimit()
+{
+	return iterationLimit.exchange(0, std::memory_order_relaxed);
+}
+
+float RenderThread::takePixelCost()
+{
+	return pixelCost.exchange(0.0f, std::memory_order_relaxed);
+}
+
+void RenderThread::run()
+{
+	glfwMakeContextCurrent(context);
+	{
+		// Vertex state isn't shared between contexts, so the quad is set up again here
+		float position[] = {
+			-1.0f, -1.0f,
+			 1.0f,  1.0f,
+			 1.0f, -1.0f,
+			-1.0f,  1.0f,
+		};
+		unsigned int indicies[] = {
+			0, 2, 1,
+			0, 1, 3
+		};
+		GLuint vertecies, index;
+		glGenBuffers(1, &vertecies);
+		glBindBuffer(GL_ARRAY_BUFFER, vertecies);
+		glBufferData(GL_ARRAY_BUFFER, 8 * sizeof(float), position, GL_STATIC_DRAW);
+		glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, 0);
+		glEnableVertexAttribArray(0);
+		glGenBuffers(1, &index);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, 6 * sizeof(unsigned int), indicies, GL_STATIC_DRAW);
+		glEnable(GL_CULL_FACE);
+
+		VariantCache<FractalVariant, FractalProgram> programs;
+		// Parameters every program reads, uploaded only when they change
+		UniformBuffer<FractalBlock> fractalBlock(0);
+		UniformBuffer<ColorBlock> colorBlock(1);
+
+		ProgressiveRenderer progressiveRenderer;
+		FractalParams renderedParams;
+		PrecisionMode renderedPrecision = PrecisionMode::Float;
+		ReferenceOrbit referenceOrbit;
+		SeriesApproximation series;
+		GLuint orbitBuffers[2];
+		glGenBuffers(2, orbitBuffers);
+		// Framebuffers aren't shared either, the UI thread attaches the textures to its own
+		GLuint frameFramebuffers[3];
+		glGenFramebuffers(3, frameFramebuffers);
+
+		std::unique_ptr<RenderSnapshot> snapshot;
+		// Program whose view uniforms are set. Time sliced passes stay unstarted over several slices,
+		// so the renderer can't tell.
+		const FractalProgram* configuredProgram = nullptr;
+		// Whether the escape statistics of the current view were gathered
+		bool statisticsGathered = false;
+		std::vector<float> centerSamples;
+		// Of the view that raised the iteration limit last
+		EscapeStatistics raisedFrom;
+		// Start and pixel count of the view being timed, while timing
+		bool timing = false;
+		double timingStart = 0.0;
+		int timedPixels = 0;
+		// Accumulation is held while snapshots keep changing the colors
+		bool colorsChanging = false;
+		auto reportPixelCost = [&](double progress) {
+			timing = false;
+			if (progress <= 0.0) return;
+			double elapsed = (glfwGetTime() - timingStart) * 1000.0;
+			pixelCost.store(static_cast<float>(elapsed / progress / timedPixels * 1e6), std::memory_order_relaxed);
+		};
+		while (true)
+		{
+			{
+				// Sleeps until a snapshot arrives, unless the current one still has passes left
+				std::unique_lock<std::mutex> lock(wakeMutex);
+				auto ready = [&] {
+					return !running || mailbox.load(std::memory_order_acquire) != nullptr
+						|| (snapshot && !progressiveRenderer.isComplete());
+				};
+				if (!colorsChanging)
+				{
+					wake.wait(lock, ready);
+				}
+				else if (!wake.wait_for(lock, std::chrono::duration<double>(colorSettleTime), ready))
+				{
+					// No snapshot followed the last color change, so the colors stopped
+					colorsChanging = false;
+					progressiveRenderer.restartAccumulation();
+				}
+				if (!running) break;
+			}
+			RenderSnapshot* latest = mailbox.exchange(nullptr, std::memory_order_acq_rel);
+			bool colorsChanged = false;
+			if (latest)
+			{
+				colorsChanged = snapshot && !snapshot->sameColors(*latest);
+				RenderSnapshot* previous = snapshot.release();
+				snapshot.reset(latest);
+				if (previous) recycle(previous);
+			}
+			const FractalParams& params = snapshot->params;
+			PrecisionMode precision = snapshot->precision;
+
+			// Escape uniforms only change when the view does, which restarts the refinement.
+			// Coloring is a separate pass, so the color controls never trigger it.
+			FractalProgram& activeProgram = programs.get(getVariant(*snapshot));
+			const Shader& activeShader = activeProgram.shader;
+			progressiveRenderer.resize(params.w, params.h);
+			glViewport(0, 0, params.w, params.h);
+			bool viewChanged = !configuredProgram || !params.sameEscape(renderedParams) || precision != renderedPrecision;
+			// A pan by whole pixels keeps what's already rendered, it only has to be moved
+			int shiftX = 0, shiftY = 0;
+			bool panned = viewChanged && configuredProgram && precision == renderedPrecision
+				&& params.getPixelShift(renderedParams, shiftX, shiftY);
+			// So does raising the iteration limit, the centers that reached the old one continue
+			int previousIterations = renderedParams.maxIterations;
+			bool deepened = viewChanged && configuredProgram && precision == renderedPrecision
+				&& params.maxIterations > previousIterations && params.cx == renderedParams.cx
+				&& params.cy == renderedParams.cy && params.sameFraming(renderedParams);
+			if (viewChanged)
+			{
+				statisticsGathered = false;
+				renderedParams = params;
+				renderedPrecision = precision;
+				fractalBlock.upload(FractalBlock::from(params));
+				if (precision == PrecisionMode::Perturbation)
+				{
+					// The reference only changes when the view leaves it or needs more precision or iterations
+					double referenceX = referenceOrbit.offsetX(params);
+					double referenceY = referenceOrbit.offsetY(params);
+					bool orbitChanged = referenceOrbit.update(params);
+					// Continued pixels hold offsets from the reference, it may get longer but mustn't move
+					if (referenceOrbit.offsetX(params) != referenceX || referenceOrbit.offsetY(params) != referenceY)
+					{
+						deepened = false;
+					}
+					if (orbitChanged)
+					{
+						uploadReferenceOrbit(referenceOrbit, orbitBuffers);
+					}
+					series.update(referenceOrbit, params, orbitChanged);
+					skippedIterations.store(series.getSkipIterations(), std::memory_order_relaxed);
+				}
+			}
+			// Another variant, e.g. for a new grid size, needs the uniforms even if the view is the same
+			if (viewChanged || &activeProgram != configuredProgram)
+			{
+				configuredProgram = &activeProgram;
+				if (precision == PrecisionMode::Perturbation)
+				{
+					int exponent = getDeltaExponent(params);
+					double aspectRatio = static_cast<double>(params.w) / params.h;
+					setSeriesUniforms(activeProgram, series, exponent);
+					activeShader.set(activeProgram.deltaExponent, exponent);
+					activeShader.set(activeProgram.offset, static_cast<float>(std::ldexp(referenceOrbit.offsetX(params), -exponent)),
+						static_cast<float>(std::ldexp(referenceOrbit.offsetY(params), -exponent)));
+					activeShader.set(activeProgram.viewSize, static_cast<float>(std::ldexp(4.0 * aspectRatio / params.zoom, -exponent)),
+						static_cast<float>(std::ldexp(4.0 / params.zoom, -exponent)));
+					activeShader.set(activeProgram.orbitLength, static_cast<int>(referenceOrbit.getX().size()));
+					activeShader.set(activeProgram.criticalLength, static_cast<int>(referenceOrbit.getCriticalX().size()));
+				}
+				else if (precision == PrecisionMode::DoubleSingle)
+				{
+					// The low halves are what's left of the exact center after rounding to float
+					float hiX = static_cast<float>(params.cx.toDouble());
+					float hiY = static_cast<float>(params.cy.toDouble());
+					activeShader.set(activeProgram.centerHi, hiX, hiY);
+					activeShader.set(activeProgram.centerLo, (params.cx - hiX).toDouble(), (params.cy - hiY).toDouble());
+				}
+				else if (precision == PrecisionMode::Double)
+				{
+					activeShader.set(activeProgram.centerDouble, params.cx.toDouble(), params.cy.toDouble());
+				}
+				else
+				{
+					activeShader.set(activeProgram.center, params.cx.toDouble(), params.cy.toDouble());
+				}
+			}
+			// After the uniforms, the exposed strips are computed with them
+			bool shifted = false;
+			if (viewChanged)
+			{
+				if (timing) reportPixelCost(progressiveRenderer.getFullResolutionProgress());
+				shifted = panned && progressiveRenderer.shift(activeProgram, shiftX, shiftY);
+				bool resumed = deepened && progressiveRenderer.resume(previousIterations);
+				if (!shifted && !resumed)
+				{
+					progressiveRenderer.restart();
+					timing = true;
+					timingStart = glfwGetTime();
+					timedPixels = params.w * params.h;
+				}
+			}
+
+			// Accumulation frames are colored as they're added, so they need the colors up front
+			colorBlock.upload(ColorBlock::from(params, snapshot->paletteOffset));
+			ColorVariant coloring;
+			coloring.smoothColoring = snapshot->smoothColoring;
+			coloring.showPeriods = params.showPeriods;
+			progressiveRenderer.setColoring(coloring);
+			if (colorsChanged)
+			{
+				colorsChanging = true;
+				progressiveRenderer.holdAccumulation();
+			}
+			else if (latest)
+			{
+				colorsChanging = false;
+				progressiveRenderer.restartAccumulation();
+			}
+
+			// One slice per loop, so a new snapshot can interrupt a pass. Finished passes are handed
+			// over, without progressive rendering only once all of them are done.
+			progressiveRenderer.setTimeBudget(snapshot->sliceBudget);
+			progressiveRenderer.setSupersampling(snapshot->maxGrid, snapshot->edgeThreshold);
+			progressiveRenderer.setAccumulation(snapshot->accumulationFrames);
+			// A shifted frame goes out with just its strips, the refresh only starts once no pan follows it
+			bool passFinished = !shifted && progressiveRenderer.renderSlice(activeProgram);
+			bool handOver = progressiveRenderer.isStarted() && (passFinished || latest)
+				&& (snapshot->progressive || progressiveRenderer.hasFullImage() || shifted);
+			if (timing && progressiveRenderer.hasFullResolution())
+			{
+				reportPixelCost(1.0);
+			}
+			// Once every pixel has a center, a sparse grid of them tells whether the limit fits the view
+			if (snapshot->autoIterations && !statisticsGathered
+				&& progressiveRenderer.readCenters(statisticsGrid, statisticsGrid, centerSamples))
+			{
+				statisticsGathered = true;
+				EscapeStatistics statistics = gatherEscapeStatistics(centerSamples, params.maxIterations);
+				int limit = chooseIterationLimit(statistics, raisedFrom);
+				// Only a raise right before the next frame counts for it
+				raisedFrom = limit > params.maxIterations ? statistics : EscapeStatistics();
+				if (limit != params.maxIterations)
+				{
+					iterationLimit.store(limit, std::memory_order_relaxed);
+					glfwPostEmptyEvent();
+				}
+			}
+
+			Frame& frame = frames[back];
+			if (handOver && frame.presented)
+			{
+				glWaitSync(frame.presented, 0, GL_TIMEOUT_IGNORED);
+				glDeleteSync(frame.presented);
+				frame.presented = nullptr;
+			}
+			if (handOver && (frame.w != params.w || frame.h != params.h))
+			{
+				glDeleteTextures(1, &frame.texture);
+				glGenTextures(1, &frame.texture);
+				glBindTexture(GL_TEXTURE_2D, frame.texture);
+				glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, params.w, params.h, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+				glBindTexture(GL_TEXTURE_2D, 0);
+				glBindFramebuffer(GL_FRAMEBUFFER, frameFramebuffers[back]);
+				glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, frame.texture, 0);
+				frame.w = params.w;
+				frame.h = params.h;
+			}
+
+			if (handOver)
+			{
+				glBindFramebuffer(GL_FRAMEBUFFER, frameFramebuffers[back]);
+				progressiveRenderer.present();
+				glBindFramebuffer(GL_FRAMEBUFFER, 0);
+			}
+
+			// Waiting for the GPU keeps slices from queueing up faster than they finish, and the
+			// UI thread can blit the frame without a fence of its own
+			GLsync rendered = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+			glClientWaitSync(rendered, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+			glDeleteSync(rendered);
+			if (handOver)
+			{
+				back = middle.exchange(back | freshFrame, std::memory_order_acq_rel) & ~freshFrame;
+				// Wakes the UI thread from glfwWaitEventsTimeout to show it
+				glfwPostEmptyEvent();
+			}
+		}
+
+		for (Frame& frame : frames)
+		{
+			glDeleteTextures(1, &frame.texture);
+			if (frame.presented) glDeleteSync(frame.presented);
+			frame = Frame();
+		}
+		glDeleteFramebuffers(3, frameFramebuffers);
+		glDeleteBuffers(2, orbitBuffers);
+		glDeleteBuffers(1, &vertecies);
+		glDeleteBuffers(1, &index);
+	}
+	glfwMakeContextCurrent(nullptr);
+}
@@ -0,0 +1,48 @@
+#include <ResolutionGovernor.h>
+
+#include <algorithm>
+#include <cmath>
+
+void ResolutionGovernor::setIdleScale(double scale)
+{
+	idleScale = scale;
+	movingScale = std::min(movingScale, idleScale);
+}
+
+void ResolutionGovernor::viewMoved(double now)
+{
+	lastMove = now;
+}
+
+bool ResolutionGovernor::isMoving(double now) const
+{
+	return now - lastMove < idleDelay;
+}
+
+void ResolutionGovernor::update(double cost, double budget, int pixels)
+{
+	if (cost > 0.0)
+	{
+		// One slow view, e.g. one that compiled a program first, shouldn't drop the scale on its own
+		pixelCost = pixelCost > 0.0 ? (pixelCost + cost) * 0.5 : cost;
+	}
+	if (pixelCost <= 0.0 || pixels <= 0) return;
+	// The cost grows with the pixel count, so with the square of the scale
+	double scale = std::sqrt(budget / (pixelCost * pixels * 1e-6));
+	double fitting = std::floor(scale / scaleStep) * scaleStep;
+	// Going up takes some headroom, so noise in the timings doesn't flip between two steps
+	double roomy = std::floor(scale * raiseMargin / scaleStep) * scaleStep;
+	if (fitting < movingScale)
+	{
+		movingScale = std::max(fitting, minScale);
+	}
+	else if (roomy > movingScale)
+	{
+		movingScale = std::min(roomy, idleScale);
+	}
+}
+
+double ResolutionGovernor::getScale(double now) const
+{
+	return isMoving(now) ? movingScale : idleScale;
+}
@@ -0,0 +1,170 @@
+#include <SeriesApproximation.h>
+
+#include <algorithm>
+#include <cmath>
+
+SeriesApproximation::SeriesApproximation(int terms, double tolerance)
+	: terms(terms), tolerance(tolerance), coefficientsX(terms, 0.0), coefficientsY(terms, 0.0)
+{
+}
+
+void SeriesApproximation::reset()
+{
+	skipIterations = 0;
+	lastZoom = 0.0;
+}
+
+bool SeriesApproximation::update(const ReferenceOrbit& orbit, const FractalParams& params, bool orbitChanged)
+{
+	double offsetX = orbit.offsetX(params), offsetY = orbit.offsetY(params);
+	if (!orbitChanged && offsetX == lastOffsetX && offsetY == lastOffsetY && params.zoom == lastZoom
+		&& params.w == lastW && params.h == lastH && params.maxIterations == lastMaxIterations)
+	{
+		return false;
+	}
+	compute(orbit, params);
+	return true;
+}
+
+void SeriesApproximation::compute(const ReferenceOrbit& orbit, const FractalParams& params)
+{
+	lastOffsetX = orbit.offsetX(params);
+	lastOffsetY = orbit.offsetY(params);
+	lastZoom = params.zoom;
+	lastW = params.w;
+	lastH = params.h;
+	lastMaxIterations = params.maxIterations;
+
+	// Offsets of the view's corners, edge midpoints and center from the reference
+	double halfW = 4.0 * params.w / params.h / params.zoom;
+	double halfH = 4.0 / params.zoom;
+	radius = std::hypot(std::fabs(lastOffsetX) + halfW, std::fabs(lastOffsetY) + halfH);
+
+	constexpr int numProbes = 9;
+	double probeU[numProbes], probeV[numProbes];
+	double probeX[numProbes], probeY[numProbes];
+	double probeDcX[numProbes], probeDcY[numProbes];
+	bool julia = orbit.isJulia();
+	for (int p = 0; p < numProbes; p++)
+	{
+		double dx = lastOffsetX + (p % 3 - 1) * halfW;
+		double dy = lastOffsetY + (p / 3 - 1) * halfH;
+		probeU[p] = dx / radius;
+		probeV[p] = dy / radius;
+		probeX[p] = julia ? dx : 0.0;
+		probeY[p] = julia ? dy : 0.0;
+		probeDcX[p] = julia ? 0.0 : dx;
+		probeDcY[p] = julia ? 0.0 : dy;
+	}
+
+	// delta_0 is d itself for Julia sets and 0 for Mandelbrot, whose deltaC enters a_1 every step
+	std::vector<double> ax(terms, 0.0), ay(terms, 0.0), nextX(terms), nextY(terms);
+	if (julia) ax[0] = radius;
+	coefficientsX = ax;
+	coefficientsY = ay;
+	skipIterations = 0;
+
+	const std::vector<double>& zx = orbit.getX();
+	const std::vector<double>& zy = orbit.getY();
+	int last = std::min(static_cast<int>(zx.size()) - 1, params.maxIterations);
+	for (int n = 0; n < last; n++)
+	{
+		double Zr = zx[n], Zi = zy[n];
+
+		// a_k' = 2 Z a_k + sum_{i + j = k} a_i a_j (+ radius for a_1 of Mandelbrot)
+		for (int k = 0; k < terms; k++)
+		{
+			double sx = 2.0 * (Zr * ax[k] - Zi * ay[k]);
+			double sy = 2.0 * (Zr * ay[k] + Zi * ax[k]);
+			for (int i = 0; i < k; i++)
+			{
+				int j = k - 1 - i;
+				sx += ax[i] * ax[j] - ay[i] * ay[j];
+				sy += ax[i] * ay[j] + ay[i] * ax[j];
+			}
+			nextX[k] = sx;
+			nextY[k] = sy;
+		}
+		if (!julia) nextX[0] += radius;
+		ax.swap(nextX);
+		ay.swap(nextY);
+
+		// |delta| <= sum |a_k| over the view, no pixel may be able to escape inside the skipped range
+		double bound = 0.0;
+		for (int k = 0; k < terms; k++)
+		{
+			bound += std::hypot(ax[k], ay[k]);
+		}
+		bool valid = std::isfinite(bound) && std::hypot(zx[n + 1], zy[n + 1]) + bound < 2.0;
+		for (int p = 0; p < numProbes && valid; p++)
+		{
+			double dx = probeX[p], dy = probeY[p];
+			probeX[p] = 2.0 * (Zr * dx - Zi * dy) + dx * dx - dy * dy + probeDcX[p];
+			probeY[p] = 2.0 * (Zr * dy + Zi * dx) + 2.0 * dx * dy + probeDcY[p];
+
+			// Skipping can't go past a probe that escapes or would rebase
+			double zr = zx[n + 1] + probeX[p], zi = zy[n + 1] + probeY[p];
+			double magnitude = zr * zr + zi * zi;
+			double deltaMagnitude = probeX[p] * probeX[p] + probeY[p] * probeY[p];
+			if (magnitude >= 4.0 || magnitude < deltaMagnitude)
+			{
+				valid = false;
+				break;
+			}
+
+			double sx = 0.0, sy = 0.0;
+			for (int k = terms - 1; k >= 0; k--)
+			{
+				double tx = sx + ax[k], ty = sy + ay[k];
+				sx = tx * probeU[p] - ty * probeV[p];
+				sy = tx * probeV[p] + ty * probeU[p];
+			}
+			double errorX = sx - probeX[p], errorY = sy - probeY[p];
+			valid = errorX * errorX + errorY * errorY <= tolerance * tolerance * deltaMagnitude;
+		}
+		if (!valid) break;
+
+		skipIterations = n + 1;
+		coefficientsX = ax;
+		coefficientsY = ay;
+	}
+}
+
+int SeriesApproximation::getSkipIterations() const
+{
+	return skipIterations;
+}
+
+int SeriesApproximation::getTerms() const
+{
+	return terms;
+}
+
+double SeriesApproximation::getRadius() const
+{
+	return radius;
+}
+
+const std::vector<double>& SeriesApproximation::getCoefficientsX() const
+{
+	return coefficientsX;
+}
+
+const std::vector<double>& SeriesApproximation::getCoefficientsY() const
+{
+	return coefficientsY;
+}
+
+void SeriesApproximation::evaluate(double dx, double dy, double& outX, double& outY) const
+{
+	double u = dx / radius, v = dy / radius;
+	double sx = 0.0, sy = 0.0;
+	for (int k = terms - 1; k >= 0; k--)
+	{
+		double tx = sx + coefficientsX[k], ty = sy + coefficientsY[k];
+		sx = tx * u - ty * v;
+		sy = tx * v + ty * u;
+	}
+	outX = sx;
+	outY = sy;
+}
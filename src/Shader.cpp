@@ -1,22 +1,74 @@
 #include <Shader.h>
-#include <FileUtils.h>
+#include <ProgramCache.h>
+#include <ShaderSources.h>
 
-Shader::Shader(const std::string& vertexShader, const std::string& fragmentShader)
+#include <iostream>
+
+Shader::Shader(const std::string& vertexShader, std::initializer_list<const char*> fragmentShaders, const std::string& defines)
+{
+	std::string vertexSource = ShaderSources::get(vertexShader);
+	std::string name = vertexShader;
+	std::string fragmentSource = concatenate(fragmentShaders, name);
+	fragmentSource.insert(fragmentSource.find('\n') + 1, defines);
+	link({GL_VERTEX_SHADER, GL_FRAGMENT_SHADER}, {vertexSource, fragmentSource}, name);
+}
+
+Shader::Shader(std::initializer_list<const char*> computeShaders, const std::string& defines)
+{
+	std::string name;
+	std::string computeSource = concatenate(computeShaders, name);
+	computeSource.insert(computeSource.find('\n') + 1, defines);
+	link({GL_COMPUTE_SHADER}, {computeSource}, name);
+}
+
+std::string Shader::concatenate(std::initializer_list<const char*> files, std::string& name)
+{
+	std::string source;
+	for (const char* file : files)
+	{
+		source += ShaderSources::get(file);
+		name += name.empty() ? file : std::string(", ") + file;
+	}
+	return source;
+}
+
+void Shader::link(const std::vector<GLenum>& types, const std::vector<std::string>& sources, const std::string& name)
 {
 	GLuint program = glCreateProgram();
+	programID = program;
 
-	GLuint vs = loadShader(GL_VERTEX_SHADER, vertexShader);
-	GLuint fs = loadShader(GL_FRAGMENT_SHADER, fragmentShader);
+	uint64_t key = ProgramCache::getKey(sources);
+	if (ProgramCache::load(program, key)) return;
 
-	glAttachShader(program, vs);
-	glAttachShader(program, fs);
+	std::vector<GLuint> shaders;
+	for (size_t i = 0; i < types.size(); i++)
+	{
+		shaders.push_back(loadShader(types[i], sources[i]));
+		glAttachShader(program, shaders.back());
+	}
+	glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 	glLinkProgram(program);
 	glValidateProgram(program);
 
-	glDeleteShader(vs);
-	glDeleteShader(fs);
+	for (GLuint shader : shaders)
+	{
+		glDetachShader(program, shader);
+		glDeleteShader(shader);
+	}
 
-	programID = program;
+	GLint res;
+	glGetProgramiv(program, GL_LINK_STATUS, &res);
+	if (res == GL_FALSE)
+	{
+		int len;
+		glGetProgramiv(program, GL_INFO_LOG_LENGTH, &len);
+		std::string msg(len, '\0');
+		glGetProgramInfoLog(program, len, &len, &msg[0]);
+		std::cout << "Program linking failed! (" << name << ")" << std::endl;
+		std::cout << msg << std::endl;
+		return;
+	}
+	ProgramCache::store(program, key);
 }
 
 Shader::~Shader()
@@ -42,8 +94,7 @@ GLuint Shader::getProgramID() const
 GLuint Shader::loadShader(GLuint type, const std::string& source)
 {
 	GLuint shader = glCreateShader(type);
-	std::string contents = FileUtils::readFile(source);
-	const char* src = contents.c_str();
+	const char* src = source.c_str();
 	glShaderSource(shader, 1, &src, nullptr);
 	glCompileShader(shader);
 
@@ -55,7 +106,8 @@ GLuint Shader::loadShader(GLuint type, const std::string& source)
 		glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &len);
 		std::string msg(len, '\0');
 		glGetShaderInfoLog(shader, len, &len, &msg[0]);
-		std::cout << "Shader compilation failed! (" << (type == GL_VERTEX_SHADER ? "vertex" : "fragment") << ")" << std::endl;
+		const char* stage = type == GL_VERTEX_SHADER ? "vertex" : type == GL_FRAGMENT_SHADER ? "fragment" : "compute";
+		std::cout << "Shader compilation failed! (" << stage << ")" << std::endl;
 		std::cout << msg << std::endl;
 		glDeleteShader(shader);
 		return 0;
@@ -64,26 +116,32 @@ GLuint Shader::loadShader(GLuint type, const std::string& source)
 	return shader;
 }
 
-void Shader::setUniform1f(const std::string& name, float value)
+void Shader::set(Uniform<float> uniform, float value) const
+{
+	glProgramUniform1f(programID, uniform.location, value);
+}
+
+void Shader::set(Uniform<int> uniform, int value) const
+{
+	glProgramUniform1i(programID, uniform.location, value);
+}
+
+void Shader::set(Uniform<glm::vec2> uniform, float x, float y) const
 {
-	GLuint loc = glGetUniformLocation(programID, name.c_str());
-	glUniform1f(loc, value);
+	glProgramUniform2f(programID, uniform.location, x, y);
 }
 
-void Shader::setUniform2f(const std::string& name, float val1, float val2)
+void Shader::set(Uniform<glm::ivec2> uniform, int x, int y) const
 {
-	GLuint loc = glGetUniformLocation(programID, name.c_str());
-	glUniform2f(loc, val1, val2);
+	glProgramUniform2i(programID, uniform.location, x, y);
 }
 
-void Shader::setUniform1i(const std::string& name, int value)
+void Shader::set(Uniform<glm::dvec2> uniform, double x, double y) const
 {
-	GLuint loc = glGetUniformLocation(programID, name.c_str());
-	glUniform1i(loc, value);
+	glProgramUniform2d(programID, uniform.location, x, y);
 }
 
-void Shader::setUniform2i(const std::string& name, int val1, int val2)
+void Shader::set(Uniform<glm::vec2> uniform, int count, const float* values) const
 {
-	GLuint loc = glGetUniformLocation(programID, name.c_str());
-	glUniform2i(loc, val1, val2);
+	glProgramUniform2fv(programID, uniform.location, count, values);
 }
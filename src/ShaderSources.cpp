@@ -0,0 +1,16 @@
+#include <ShaderSources.h>
+
+#include <iostream>
+
+std::string ShaderSources::get(const std::string& name)
+{
+	for (int i = 0; i < fileCount; i++)
+	{
+		if (name == files[i].name)
+		{
+			return std::string(reinterpret_cast<const char*>(files[i].data), files[i].size);
+		}
+	}
+	std::cout << "No embedded shader named " << name << std::endl;
+	return "";
+}
@@ -0,0 +1,94 @@
+#include <ThreadPool.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+ThreadPool::ThreadPool(unsigned int threadCount)
+{
+	if (threadCount == 0)
+	{
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+	}
+	for (unsigned int i = 0; i < threadCount; i++)
+	{
+		workers.emplace_back(&ThreadPool::workerLoop, this);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	taskAvailable.notify_all();
+	for (std::thread& worker : workers)
+	{
+		worker.join();
+	}
+}
+
+unsigned int ThreadPool::size() const
+{
+	return static_cast<unsigned int>(workers.size());
+}
+
+void ThreadPool::workerLoop()
+{
+	while (true)
+	{
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			taskAvailable.wait(lock, [this] { return stopping || !tasks.empty(); });
+			if (stopping && tasks.empty()) return;
+			task = std::move(tasks.front());
+			tasks.pop();
+			activeTasks++;
+		}
+
+		task();
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			activeTasks--;
+			if (activeTasks == 0 && tasks.empty())
+			{
+				allDone.notify_all();
+			}
+		}
+	}
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		tasks.push(std::move(task));
+	}
+	taskAvailable.notify_one();
+}
+
+void ThreadPool::wait()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	allDone.wait(lock, [this] { return activeTasks == 0 && tasks.empty(); });
+}
+
+void ThreadPool::parallelFor(int count, const std::function<void(int)>& body)
+{
+	// One task per worker pulling indices keeps the queue short for large counts
+	auto next = std::make_shared<std::atomic<int>>(0);
+	int taskCount = std::min<int>(count, size());
+	for (int t = 0; t < taskCount; t++)
+	{
+		submit([next, count, &body] {
+			for (int i = (*next)++; i < count; i = (*next)++)
+			{
+				body(i);
+			}
+		});
+	}
+	wait();
+}
@@ -5,13 +5,22 @@
 #include <imgui/imgui.h>
 #include <imgui/backends/imgui_impl_glfw.h>
 #include <imgui/backends/imgui_impl_opengl3.h>
+#include <BigFixed.h>
 #include <FileUtils.h>
-#include <Shader.h>
-
+#include <FractalParams.h>
+#include <FrameScheduler.h>
+#include <Headless.h>
+#include <PrecisionMode.h>
+#include <RenderThread.h>
+#include <ResolutionGovernor.h>
+
+#include <algorithm>
+#include <cmath>
 #include <fstream>
 #include <sstream>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 enum {
 	MANDELBROT,
@@ -20,9 +29,11 @@ enum {
 
 struct WindowState
 {
-	float cx, cy;
-	float zoom;
+	BigFixed cx, cy;
+	double zoom;
 	int w, h;
+	// Size of the render target relative to the framebuffer, set by the resolution governor
+	double renderScale = 1.0;
 };
 
 struct ApplicationState
@@ -30,28 +41,78 @@ struct ApplicationState
 	WindowState window;
 	std::unordered_map<int, bool> keyMap;
 	double mouseClickX, mouseClickY;
-	double prevCx, prevCy;
+	BigFixed prevCx, prevCy;
 	double juliaCx = NAN, juliaCy = NAN;
 	bool leftButtonHeld = false, rightButtonHeld = false;
+	// Fraction of a pixel the movement keys moved the view by that isn't applied yet
+	double keyCarryX = 0.0, keyCarryY = 0.0;
+	FrameScheduler scheduler;
 };
 
+int getRenderWidth(const WindowState& ws)
+{
+	return std::max(1, static_cast<int>(std::lround(ws.w * ws.renderScale)));
+}
+
+int getRenderHeight(const WindowState& ws)
+{
+	return std::max(1, static_cast<int>(std::lround(ws.h * ws.renderScale)));
+}
+
+// Distance between neighbouring pixel centers of the render target, see FractalParams::getPixelSize
+double getPixelSize(const WindowState& ws)
+{
+	return 8.0 / (ws.zoom * getRenderHeight(ws));
+}
+
+// Whether params shows another part of the plane than the application state, the size aside
+bool viewMoved(const ApplicationState& as, const FractalParams& params)
+{
+	auto same = [](double a, double b) { return a == b || (std::isnan(a) && std::isnan(b)); };
+	return !(as.window.cx == params.cx && as.window.cy == params.cy) || as.window.zoom != params.zoom
+		|| !same(as.juliaCx, params.juliaCx) || !same(as.juliaCy, params.juliaCy);
+}
+
 void framebufferSizeCallback(GLFWwindow* window, int width, int height)
 {
     glViewport(0, 0, width, height);
-	WindowState* ws = &(static_cast<ApplicationState*>(glfwGetWindowUserPointer(window)))->window;
-	ws->w = width;
-	ws->h = height;
+	ApplicationState* as = static_cast<ApplicationState*>(glfwGetWindowUserPointer(window));
+	as->window.w = width;
+	as->window.h = height;
+	as->scheduler.invalidate();
+}
+
+// Events ImGui reacts to without them changing the view, they still need a frame drawn
+void windowRefreshCallback(GLFWwindow* window)
+{
+	static_cast<ApplicationState*>(glfwGetWindowUserPointer(window))->scheduler.invalidate();
+}
+
+void windowFocusCallback(GLFWwindow* window, int focused)
+{
+	static_cast<ApplicationState*>(glfwGetWindowUserPointer(window))->scheduler.invalidate();
+}
+
+void cursorEnterCallback(GLFWwindow* window, int entered)
+{
+	static_cast<ApplicationState*>(glfwGetWindowUserPointer(window))->scheduler.invalidate();
 }
 
 void scrollCallback(GLFWwindow* window, double xoffset, double yoffset)
 {
-	WindowState* ws = &(static_cast<ApplicationState*>(glfwGetWindowUserPointer(window)))->window;
+	ApplicationState* as = static_cast<ApplicationState*>(glfwGetWindowUserPointer(window));
+	as->scheduler.invalidate();
+	WindowState* ws = &as->window;
 	static double zoomInFactor = 1.1;
 	constexpr static double zoomOutFactor = 1.0 / 1.1;
 
 	if (yoffset > 0)
 	{
-		ws->zoom *= zoomInFactor;
+		if (ws->zoom >= maxZoom) return;
+		ws->zoom = std::min(ws->zoom * zoomInFactor, maxZoom);
+		// Grow the center's precision with the zoom so panning keeps resolving single pixels
+		ws->cx.ensureFractionBits(BigFixed::bitsForZoom(ws->zoom));
+		ws->cy.ensureFractionBits(BigFixed::bitsForZoom(ws->zoom));
 	}
 	else
 	{
@@ -63,6 +124,7 @@ void scrollCallback(GLFWwindow* window, double xoffset, double yoffset)
 void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods)
 {
 	ApplicationState* as = static_cast<ApplicationState*>(glfwGetWindowUserPointer(window));
+	as->scheduler.invalidate();
 	//std::unordered_map<int, bool> *keyMap = as->keyMap;
 	auto& keyMap = as->keyMap;
 	if (keyMap.find(key) != keyMap.end())
@@ -85,29 +147,36 @@ void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods
 void cursorPositionCallback(GLFWwindow* window, double xpos, double ypos)
 {
 	ApplicationState* as = static_cast<ApplicationState*>(glfwGetWindowUserPointer(window));
+	as->scheduler.invalidate();
 	double dx = as->mouseClickX - xpos;
     double dy = ypos - as->mouseClickY;
 
 	// 135 is from 1080 / 8,
-    double coordX = as->prevCx + dx / (135 * as->window.zoom); 
-	double coordY = as->prevCy + dy / (135 * as->window.zoom);
+    double offsetX = dx / (135 * as->window.zoom); 
+	double offsetY = dy / (135 * as->window.zoom);
 	if (as->leftButtonHeld)
 	{
-        as->window.cx = coordX;
-        as->window.cy = coordY;
+		// The view moves by whole render target pixels, so the render thread can shift the last frame
+		int windowWidth, windowHeight;
+		glfwGetWindowSize(window, &windowWidth, &windowHeight);
+		double scale = windowWidth > 0 ? static_cast<double>(getRenderWidth(as->window)) / windowWidth : 1.0;
+		double pixelSize = getPixelSize(as->window);
+        as->window.cx = as->prevCx + std::round(dx * scale) * pixelSize;
+        as->window.cy = as->prevCy + std::round(dy * scale) * pixelSize;
 	}
 	else if (as->rightButtonHeld)
 	{
 		if (std::isnan(as->juliaCx) || as->window.zoom > 8) return;
-        as->juliaCx = coordX;
-        as->juliaCy = coordY;
+        as->juliaCx = as->prevCx.toDouble() + offsetX;
+        as->juliaCy = as->prevCy.toDouble() + offsetY;
 	}
 }
 
 void mouseCallback(GLFWwindow* window, int button, int action, int mods)
 {
-	if (ImGui::GetIO().WantCaptureMouse) return;
 	ApplicationState* as = static_cast<ApplicationState*>(glfwGetWindowUserPointer(window));
+	as->scheduler.invalidate();
+	if (ImGui::GetIO().WantCaptureMouse) return;
 	as->leftButtonHeld = (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS);
 	as->rightButtonHeld = (button == GLFW_MOUSE_BUTTON_RIGHT && action == GLFW_PRESS);
 	glfwGetCursorPos(window, &as->mouseClickX, &as->mouseClickY);
@@ -118,24 +187,54 @@ void mouseCallback(GLFWwindow* window, int button, int action, int mods)
 	}
 }
 
-void handleKeyMovement(ApplicationState &as, double deltaTime)
+// Returns whether a movement key is held
+bool handleKeyMovement(ApplicationState &as, double deltaTime)
 {
 	double moveSpeed = 2.5f * deltaTime / as.window.zoom;
-	float dy = 0.0f, dx = 0.0f;
+	double dy = 0.0, dx = 0.0;
 	if (as.keyMap[GLFW_KEY_W]) dy += moveSpeed;
 	if (as.keyMap[GLFW_KEY_A]) dx -= moveSpeed;
 	if (as.keyMap[GLFW_KEY_S]) dy -= moveSpeed;
 	if (as.keyMap[GLFW_KEY_D]) dx += moveSpeed;
-	as.window.cx += dx;
-	as.window.cy += dy;
+	// Whole pixels at a time like dragging, the rest carries over to the next frame
+	double pixelSize = getPixelSize(as.window);
+	as.keyCarryX += dx / pixelSize;
+	as.keyCarryY += dy / pixelSize;
+	double pixelsX = std::trunc(as.keyCarryX);
+	double pixelsY = std::trunc(as.keyCarryY);
+	as.keyCarryX -= pixelsX;
+	as.keyCarryY -= pixelsY;
+	as.window.cx += pixelsX * pixelSize;
+	as.window.cy += pixelsY * pixelSize;
+	return as.keyMap[GLFW_KEY_W] || as.keyMap[GLFW_KEY_A] || as.keyMap[GLFW_KEY_S] || as.keyMap[GLFW_KEY_D];
+}
+
+FractalParams getFractalParams(const ApplicationState& as, int maxIterations, int baseIterations)
+{
+	FractalParams params;
+	params.cx = as.window.cx;
+	params.cy = as.window.cy;
+	params.zoom = as.window.zoom;
+	params.w = getRenderWidth(as.window);
+	params.h = getRenderHeight(as.window);
+	params.maxIterations = maxIterations;
+	params.baseIterations = baseIterations;
+	params.juliaCx = as.juliaCx;
+	params.juliaCy = as.juliaCy;
+	return params;
 }
 
 ImVec4 GetButtonColor(bool isActive) {
     return isActive ? ImVec4(0.0, 0.4, 1.0, 0.5) : ImVec4(0.0, 0.0, 0.0, 0.5);
 }
 
-int main()
+int main(int argc, char** argv)
 {
+	if (argc > 1 && std::string(argv[1]) == "--headless")
+	{
+		return runHeadless(argc, argv);
+	}
+
 	GLFWwindow* window;
 
 	int maxIterations = 128;
@@ -169,6 +268,9 @@ int main()
 	glfwSetKeyCallback(window, keyCallback);
 	glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
 	glfwSetScrollCallback(window, scrollCallback);
+	glfwSetWindowRefreshCallback(window, windowRefreshCallback);
+	glfwSetWindowFocusCallback(window, windowFocusCallback);
+	glfwSetCursorEnterCallback(window, cursorEnterCallback);
 
 	IMGUI_CHECKVERSION();
 	ImGui::CreateContext();
@@ -187,43 +289,49 @@ int main()
 
 	std::cout << glGetString(GL_VERSION) << std::endl;
 
-	float position[] = {
-		-1.0f, -1.0f,
-		 1.0f,  1.0f,
-		 1.0f, -1.0f,
-		-1.0f,  1.0f,
-	};
-
-	GLuint vertecies;
-	glGenBuffers(1, &vertecies);
-	glBindBuffer(GL_ARRAY_BUFFER, vertecies);
-	glBufferData(GL_ARRAY_BUFFER, 8 * sizeof(float), position, GL_STATIC_DRAW);
-	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, 0);
-	glEnableVertexAttribArray(0);
-
-	unsigned int indicies[] = {
-		0, 2, 1,
-		0, 1, 3
-	};
-
-	GLuint index;
-	glGenBuffers(1, &index);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, 6 * sizeof(unsigned int), indicies, GL_STATIC_DRAW);
-
-	Shader program = Shader("../src/shaders/shader.vert", "../src/shaders/shader.frag");
-	program.use();
-
-	program.setUniform1f("u_zoom", applicationState.window.zoom);
-	program.setUniform2i("u_resolution", applicationState.window.w, applicationState.window.h);
-	program.setUniform2f("u_center", applicationState.window.cx, applicationState.window.cy);
-	program.setUniform1i("u_MAX_ITERATIONS", maxIterations);
-	program.setUniform1i("u_BASE_ITERATIONS", baseIterations);
-	program.setUniform1f("u_saturation", saturation);
-	program.setUniform1f("u_brightness", brightness);
-	program.setUniform2f("u_julia_c", applicationState.juliaCx, applicationState.juliaCy);
-
-	glEnable(GL_CULL_FACE);
+	// 0 lets the zoom pick the precision, otherwise it's PrecisionMode + 1
+	const char* precisionItems[] = {"Auto", "Float", "Double-Single", "Double", "Perturbation"};
+	int precisionSetting = 0;
+	// Lets the escape statistics of each finished frame set U_MAX_ITERATIONS
+	bool autoIterations = true;
+	bool periodicity = true;
+	bool showPeriods = false;
+	bool hasFp64 = GLEW_ARB_gpu_shader_fp64;
+	// Shows a coarse preview right away and refines it over the following frames
+	bool progressive = true;
+	// Iterates in compute shaders, whose anti-aliasing pass only dispatches the edge pixels
+	bool computeShaders = false;
+	// Splits the passes into tiles drawn over several submits, so a heavy pass can't stall the desktop
+	bool timeSlicing = true;
+	float sliceBudget = 8.0f;
+	// Edges are supersampled with up to 4, 16 or 64 samples per pixel
+	const char* sampleItems[] = {"4", "16", "64"};
+	int sampleSetting = 1;
+	float edgeThreshold = 1.0f;
+	// Keeps adding jittered samples while the view stays still
+	bool temporalAccumulation = true;
+	int accumulationFrames = 64;
+	// Renders a moving view at a lower resolution when that's what keeps up with the FPS limit
+	bool dynamicResolution = true;
+	float idleScale = 1.0f;
+	ResolutionGovernor resolutionGovernor;
+	bool smoothColoring = false;
+	bool cyclePalette = false;
+	float paletteOffset = 0.0f;
+
+	// The fractal is rendered on its own thread, into a hidden window's context sharing this one's textures
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	GLFWwindow* renderContext = glfwCreateWindow(1, 1, "FractalDive", NULL, window);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+	if (!renderContext)
+	{
+		std::cout << "Failed to create the render context" << std::endl;
+		return -1;
+	}
+	RenderThread renderThread(renderContext);
+	renderThread.start();
+	RenderSnapshot publishedSnapshot;
+	bool published = false;
 
 	int maxFPS;
 
@@ -237,18 +345,46 @@ int main()
 	float targetFrameTime = 1.0f / targetFPS;
 	double lastDrawTime = glfwGetTime();
 	double lastKeyTime = glfwGetTime();
+	bool keyMoving = false;
+	FrameScheduler& scheduler = applicationState.scheduler;
 
 	while (!glfwWindowShouldClose(window)) 
 	{
-		glfwPollEvents();
+		// Sleeps while nothing changes instead of spinning on glfwPollEvents
+		scheduler.wait(targetFrameTime);
 
 		double currentTime = glfwGetTime();
 		double deltaDrawTime = currentTime - lastDrawTime;
-		double deltaKeyTime = currentTime - lastKeyTime;
-		handleKeyMovement(applicationState, deltaKeyTime);
+		// The loop may have slept before a key got pressed, so time only counts once it's held
+		double deltaKeyTime = keyMoving ? currentTime - lastKeyTime : 0.0;
+		keyMoving = handleKeyMovement(applicationState, deltaKeyTime);
 		lastKeyTime = currentTime;
 
-		if (deltaDrawTime > targetFrameTime) {
+		// The render thread woke the loop with a finished pass
+		if (renderThread.hasNewFrame())
+		{
+			scheduler.invalidate();
+		}
+		// Or with a limit that suits the view better than the one it rendered with
+		int iterationLimit = renderThread.takeIterationLimit();
+		if (autoIterations && iterationLimit > 0)
+		{
+			maxIterations = iterationLimit;
+			scheduler.invalidate();
+		}
+
+		// A moving view renders at the scale that meets the frame budget, a resting one at the idle scale
+		if (published && viewMoved(applicationState, publishedSnapshot.params))
+		{
+			resolutionGovernor.viewMoved(currentTime);
+		}
+		resolutionGovernor.setIdleScale(idleScale);
+		resolutionGovernor.update(renderThread.takePixelCost(), 1000.0 / targetFPS, applicationState.window.w * applicationState.window.h);
+		applicationState.window.renderScale = dynamicResolution ? resolutionGovernor.getScale(currentTime) : 1.0;
+
+		bool draw = scheduler.shouldDraw(currentTime, targetFrameTime);
+		if (draw)
+		{
 			ImGui_ImplOpenGL3_NewFrame();
 			ImGui_ImplGlfw_NewFrame();
 			ImGui::NewFrame();
@@ -280,51 +416,136 @@ int main()
 			if (ImGui::SliderInt("FPS Limit", &targetFPS, 1, maxFPS)) {
 				targetFrameTime = 1.0f / targetFPS;  // Update the target frame time
 			}
-			if (ImGui::SliderInt("U_MAX_ITERATIONS", &maxIterations, 1, 1024))
+			// Deep zooms need far more iterations, which the series approximation keeps affordable
+			ImGui::BeginDisabled(autoIterations);
+			ImGui::SliderInt("U_MAX_ITERATIONS", &maxIterations, 1, 1000000, "%d", ImGuiSliderFlags_Logarithmic);
+			ImGui::EndDisabled();
+			ImGui::SameLine();
+			ImGui::Checkbox("Auto", &autoIterations);
+			ImGui::SliderInt("U_BASE_ITERATIONS", &baseIterations, 1, 1024);
+			ImGui::Combo("Precision", &precisionSetting, precisionItems, IM_ARRAYSIZE(precisionItems));
+
+			ImGui::Checkbox("Periodicity Check", &periodicity);
+			ImGui::SameLine();
+			ImGui::Checkbox("Show Periods", &showPeriods);
+			ImGui::Checkbox("Progressive Rendering", &progressive);
+			ImGui::SameLine();
+			ImGui::Checkbox("Compute Shaders", &computeShaders);
+			ImGui::Checkbox("Time Slicing", &timeSlicing);
+			if (timeSlicing)
+			{
+				ImGui::SliderFloat("Slice Budget (ms)", &sliceBudget, 1.0f, 50.0f);
+			}
+			ImGui::Combo("Edge Samples", &sampleSetting, sampleItems, IM_ARRAYSIZE(sampleItems));
+			ImGui::SliderFloat("Edge Threshold", &edgeThreshold, 1.0f, 100.0f, "%.1f", ImGuiSliderFlags_Logarithmic);
+			ImGui::Checkbox("Temporal Accumulation", &temporalAccumulation);
+			if (temporalAccumulation)
 			{
-				program.setUniform1i("u_MAX_ITERATIONS", maxIterations);
+				ImGui::SliderInt("Accumulation Frames", &accumulationFrames, 1, 1024, "%d", ImGuiSliderFlags_Logarithmic);
 			}
-			if (ImGui::SliderInt("U_BASE_ITERATIONS", &baseIterations, 1, 1024))
+			ImGui::Checkbox("Dynamic Resolution", &dynamicResolution);
+			if (dynamicResolution)
 			{
-				program.setUniform1i("u_BASE_ITERATIONS", baseIterations);
+				ImGui::SliderFloat("Idle Resolution", &idleScale, 1.0f, 2.0f, "%.2fx");
 			}
 
-			program.setUniform1f("u_zoom", applicationState.window.zoom);
-			program.setUniform2i("u_resolution", applicationState.window.w, applicationState.window.h);
-			program.setUniform2f("u_center", applicationState.window.cx, applicationState.window.cy);
-			program.setUniform2f("u_julia_c", applicationState.juliaCx, applicationState.juliaCy);
+			// What the render thread is working on, this frame's changes are published below
+			ImGui::Text("Zoom: %.3g, %s precision", applicationState.window.zoom, getPrecisionModeName(publishedSnapshot.precision));
+			if (applicationState.window.zoom >= maxZoom)
+			{
+				ImGui::Text("Deepest supported zoom reached");
+			}
+			if (publishedSnapshot.precision == PrecisionMode::Perturbation)
+			{
+				ImGui::Text("Skipped iterations: %d", renderThread.getSkippedIterations());
+			}
+			if (dynamicResolution)
+			{
+				ImGui::Text("Render size: %dx%d", publishedSnapshot.params.w, publishedSnapshot.params.h);
+			}
 
 			ImGui::BeginGroup();
 			ImGui::Text("Color Controls");
 			float sliderWidth = (ImGui::GetContentRegionAvail().x / 2.0f) - 10.0f;
 			ImGui::PushItemWidth(sliderWidth);
-			if(ImGui::SliderFloat("Saturation", &saturation, 0, 1))
+			ImGui::SliderFloat("Saturation", &saturation, 0, 1);
+			ImGui::SliderFloat("Brightness", &brightness, 0, 1);
+			ImGui::PopItemWidth();
+			ImGui::Checkbox("Smooth Coloring", &smoothColoring);
+			ImGui::SameLine();
+			ImGui::Checkbox("Cycle Palette", &cyclePalette);
+			ImGui::EndGroup();
+
+			if (cyclePalette)
+			{
+				// Capped so turning it on after an idle stretch doesn't jump
+				paletteOffset = std::fmod(paletteOffset + static_cast<float>(std::min(deltaDrawTime, 0.1)) * 0.1f, 1.0f);
+			}
+		}
+
+		// Settings only change in the widgets of a drawn frame, input in the callbacks that invalidate
+		// the scheduler, otherwise only held keys and the resolution governor move the view. Published
+		// ahead of the swap, which may block on vsync, so input reaches the render thread as soon as
+		// it's handled.
+		bool invalidated = scheduler.takeInvalidated();
+		if (!published || invalidated || draw || keyMoving
+			|| getRenderWidth(applicationState.window) != publishedSnapshot.params.w
+			|| getRenderHeight(applicationState.window) != publishedSnapshot.params.h)
+		{
+			RenderSnapshot snapshot;
+			snapshot.params = getFractalParams(applicationState, maxIterations, baseIterations);
+			snapshot.params.periodicity = periodicity;
+			snapshot.params.showPeriods = showPeriods;
+			snapshot.params.saturation = saturation;
+			snapshot.params.brightness = brightness;
+			snapshot.precision = precisionSetting == 0
+				? choosePrecisionMode(snapshot.params, hasFp64)
+				: static_cast<PrecisionMode>(precisionSetting - 1);
+			if (snapshot.precision == PrecisionMode::Double && !hasFp64)
 			{
-				program.setUniform1f("u_saturation", saturation);
+				snapshot.precision = PrecisionMode::DoubleSingle;
 			}
-			if(ImGui::SliderFloat("Brightness", &brightness, 0, 1))
+			snapshot.progressive = progressive;
+			snapshot.compute = computeShaders;
+			snapshot.sliceBudget = timeSlicing ? sliceBudget : 0.0f;
+			snapshot.maxGrid = 2 << sampleSetting;
+			snapshot.edgeThreshold = edgeThreshold;
+			snapshot.accumulationFrames = temporalAccumulation ? accumulationFrames : 0;
+			snapshot.smoothColoring = smoothColoring;
+			snapshot.paletteOffset = paletteOffset;
+			snapshot.autoIterations = autoIterations;
+			if (!published || snapshot != publishedSnapshot)
 			{
-				program.setUniform1f("u_brightness", brightness);
+				renderThread.publish(snapshot);
+				publishedSnapshot = snapshot;
+				published = true;
 			}
-			ImGui::PopItemWidth();
-			ImGui::EndGroup();
+		}
 
+		if (draw)
+		{
 			lastDrawTime = currentTime;
 			glClear(GL_COLOR_BUFFER_BIT);
 
-			glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr);
-
+			renderThread.present(applicationState.window.w, applicationState.window.h);
 
 			ImGui::Render();
 			ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 
 			glfwSwapBuffers(window);
+			// Unfinished passes don't keep the loop busy, the render thread wakes it per pass. A moving
+			// view does until the idle resolution is back.
+			scheduler.setBusy(cyclePalette || keyMoving || (dynamicResolution && resolutionGovernor.isMoving(currentTime)));
+			scheduler.frameDrawn(currentTime);
 		}
 	}
-	
+
+	renderThread.stop();
+
 	ImGui_ImplOpenGL3_Shutdown();
 	ImGui_ImplGlfw_Shutdown();
 	ImGui::DestroyContext();
+	glfwDestroyWindow(renderContext);
 	glfwDestroyWindow(window);
 	glfwTerminate();
 	return 0;
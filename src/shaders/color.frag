@@ -0,0 +1,104 @@
+#version 430 core
+
+precision highp float;
+
+in vec2 position;
+
+// Compiled per ColorVariant: SMOOTH_COLORING uses the continuous iteration count and
+// SHOW_PERIODS colors the interior by the period of its cycle
+
+// Escape data written by the fractal shaders, the pixel centers and the ranges of the
+// supersampled pixels' samples in the pool
+uniform sampler2D u_centers;
+uniform isampler2D u_sampleRanges;
+layout(std430, binding = 2) readonly buffer SamplePool {
+	uint poolUsed;
+	uint poolCapacity;
+	vec2 poolSamples[];
+};
+// Sum of the accumulated frames' colors, with their count in alpha
+uniform sampler2D u_history;
+// Block size of the latest pass, every pixel of a block shows its lower left corner. 0 once the
+// samples are in, -1 shows the accumulated history instead.
+uniform int u_step;
+
+// Shared with the fractal shaders, only u_MAX_ITERATIONS is used here
+layout(std140, binding = 0) uniform FractalParameters {
+	ivec2 u_resolution;
+	float u_zoom;
+	int u_MAX_ITERATIONS;
+	vec2 u_julia_c;
+	float u_periodTolerance;
+};
+layout(std140, binding = 1) uniform ColorParameters {
+	int u_BASE_ITERATIONS;
+	float u_saturation;
+	float u_brightness;
+	// Shifts the hues, animating it cycles the palette
+	float u_paletteOffset;
+};
+
+out vec4 screenColor;
+
+vec3 hsvToRgb(float h, float s, float v) {
+    float p = v * (1.0 - s);
+    float q = v * (1.0 - s * fract(h * 6.0));
+    float t = v * (1.0 - s * (1.0 - fract(h * 6.0)));
+
+    if (h < 1.0/6.0) return vec3(v, t, p);
+    if (h < 2.0/6.0) return vec3(q, v, p);
+    if (h < 3.0/6.0) return vec3(p, v, t);
+    if (h < 4.0/6.0) return vec3(p, q, v);
+    if (h < 5.0/6.0) return vec3(t, p, v);
+    return vec3(v, p, q);
+}
+
+// s is vec4(iterations, smooth iterations, |z|, period)
+vec3 sampleColor(vec4 s) {
+	if (s.x >= float(u_MAX_ITERATIONS)) {
+#ifdef SHOW_PERIODS
+		return s.w > 0.0 ? hsvToRgb(fract(s.w * 0.618034), u_saturation, u_brightness * 0.5) : vec3(0.0);
+#else
+		return vec3(0.0);
+#endif
+	}
+#ifdef SMOOTH_COLORING
+	float t = s.y / float(u_BASE_ITERATIONS);
+#else
+	float t = s.x / float(u_BASE_ITERATIONS);
+#endif
+	float hue = mod(t * 5.0 + u_paletteOffset, 1.0);
+	return hsvToRgb(hue, u_saturation, u_brightness);
+}
+
+// Pool samples are vec2(iterations + period, smooth iterations)
+vec4 unpackSample(vec2 s) {
+	float maxIterations = float(u_MAX_ITERATIONS);
+	return s.x >= maxIterations ? vec4(maxIterations, s.y, 0.0, s.x - maxIterations) : vec4(s.x, s.y, 0.0, 0.0);
+}
+
+void main() {
+	ivec2 pixel = ivec2(gl_FragCoord.xy);
+	if (u_step < 0) {
+		vec4 sum = texelFetch(u_history, pixel, 0);
+		screenColor = vec4(sum.rgb / sum.a, 1.0);
+		return;
+	}
+	if (u_step > 0) {
+		screenColor = vec4(sampleColor(texelFetch(u_centers, pixel - pixel % u_step, 0)), 1.0);
+		return;
+	}
+
+	ivec2 range = texelFetch(u_sampleRanges, pixel, 0).xy;
+	if (range.y == 0) {
+		screenColor = vec4(sampleColor(texelFetch(u_centers, pixel, 0)), 1.0);
+		return;
+	}
+
+	// Supersampled edges average the colors of all their samples
+	vec3 color = vec3(0.0);
+	for (int i = 0; i < range.y; i++) {
+		color += sampleColor(unpackSample(poolSamples[range.x + i]));
+	}
+	screenColor = vec4(color / float(range.y), 1.0);
+}
\ No newline at end of file
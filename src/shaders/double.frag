@@ -0,0 +1,137 @@
+#version 430 core
+#extension GL_ARB_gpu_shader_fp64 : enable
+
+precision highp float;
+
+// Compiled per FractalVariant: JULIA iterates the pixel as z with c = u_julia_c, PERIODICITY
+// enables the cycle detection and z escapes once |z| reaches BAILOUT. passes.glsl is appended,
+// it runs the passes on the samples below.
+
+// Parameters all precisions share, bound from a uniform buffer
+layout(std140, binding = 0) uniform FractalParameters {
+	ivec2 u_resolution;
+	float u_zoom;
+	int u_MAX_ITERATIONS;
+	vec2 u_julia_c;
+	// Brent cycle detection, 0 disables it
+	float u_periodTolerance;
+};
+
+uniform dvec2 u_center;
+
+// z of each pixel center where its iteration stopped, packed by packState. Raising
+// u_MAX_ITERATIONS then continues the centers that reached the old limit instead of starting over.
+layout(std430, binding = 4) buffer IterationStates {
+	uvec4 states[];
+};
+// While continuing the centers, the u_MAX_ITERATIONS they were computed with, 0 otherwise
+uniform int u_resumeFrom;
+
+dvec2 compAdd(dvec2 z1, dvec2 z2) {
+	return z1 + z2;
+}
+
+dvec2 compMul(dvec2 z1, dvec2 z2) {
+	return dvec2((z1.x * z2.x) - (z1.y * z2.y), (z1.x * z2.y) + (z1.y * z2.x));
+}
+
+// Closed form membership of the main cardioid and the period-2 bulb, whose points never escape.
+// Returns the period of the component c is in, 1 or 2, or 0 if it's in neither.
+int mainComponentPeriod(dvec2 c) {
+	double x = c.x - 0.25;
+	double y2 = c.y * c.y;
+	double q = x * x + y2;
+	if (q * (q + x) < 0.25 * y2) return 1;
+	return (c.x + 1.0) * (c.x + 1.0) + y2 < 0.0625 ? 2 : 0;
+}
+
+// The point the sample at uv iterates and where its z starts
+void samplePoint(vec2 uv, out dvec2 c, out dvec2 z) {
+	float aspectRatio = float(u_resolution.x) / float(u_resolution.y);
+	// The offset is computed in double too, a float zoom only scales it
+	dvec2 pixel = u_center + dvec2(uv) * dvec2(4.0 * aspectRatio, 4.0) / double(u_zoom);
+#ifdef JULIA
+	c = dvec2(u_julia_c);
+	z = pixel;
+#else
+	c = pixel;
+	z = dvec2(0.0);
+#endif
+}
+
+// Iterates z from iteration iter on until it escapes or reaches u_MAX_ITERATIONS, z is left where it stopped
+vec4 escape(dvec2 c, inout dvec2 z, int iter, int period) {
+#ifdef PERIODICITY
+	// z is saved after 1, 2, 4, 8... iterations, an orbit coming back to it is in a cycle and never escapes
+	dvec2 saved = z;
+	int savedAt = iter;
+	int nextSave = max(iter * 2, 1);
+	double tolerance2 = double(u_periodTolerance) * double(u_periodTolerance);
+#endif
+	while (dot(z, z) < BAILOUT * BAILOUT && iter < u_MAX_ITERATIONS) {
+		z = compMul(z,z);
+		z = compAdd(z,c);
+		iter++;
+#ifdef PERIODICITY
+		dvec2 d = z - saved;
+		if (dot(d, d) < tolerance2) {
+			period = iter - savedAt;
+			iter = u_MAX_ITERATIONS;
+			break;
+		}
+		if (iter == nextSave) {
+			saved = z;
+			savedAt = iter;
+			nextSave *= 2;
+		}
+#endif
+	}
+	float magnitude = float(length(z));
+	// Continuous iteration count, the fractional part comes from how far past the bailout z got
+	float smoothIter = iter < u_MAX_ITERATIONS ? float(iter) + 1.0 - log2(log(magnitude)) : float(iter);
+	return vec4(float(iter), smoothIter, magnitude, float(period));
+}
+
+vec4 computeSample(vec2 uv, out dvec2 z) {
+	dvec2 c;
+	samplePoint(uv, c, z);
+	int iter = 0;
+	int period = 0;
+#ifndef JULIA
+	period = mainComponentPeriod(c);
+	if (period != 0) iter = u_MAX_ITERATIONS;
+#endif
+	return escape(c, z, iter, period);
+}
+
+vec4 computeSample(vec2 uv) {
+	dvec2 z;
+	return computeSample(uv, z);
+}
+
+uvec4 packState(dvec2 z) {
+	return uvec4(unpackDouble2x32(z.x), unpackDouble2x32(z.y));
+}
+
+// Samples the center of pixel index, keeping its state
+vec4 computeCenter(vec2 uv, int index) {
+	dvec2 z;
+	vec4 s = computeSample(uv, z);
+	states[index] = packState(z);
+	return s;
+}
+
+// Continues the center whose sample at u_resumeFrom iterations was previous. Centers that escaped
+// stay as they are, those known to be inside, having a period, only move to the new limit.
+vec4 resumeCenter(vec2 uv, int index, vec4 previous) {
+	if (previous.x < float(u_resumeFrom)) return previous;
+	if (previous.w != 0.0) return vec4(vec2(float(u_MAX_ITERATIONS)), previous.zw);
+	dvec2 c;
+	dvec2 z;
+	samplePoint(uv, c, z);
+	uvec4 state = states[index];
+	z = dvec2(packDouble2x32(state.xy), packDouble2x32(state.zw));
+	vec4 s = escape(c, z, u_resumeFrom, 0);
+	states[index] = packState(z);
+	return s;
+}
\ No newline at end of file
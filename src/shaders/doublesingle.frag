@@ -0,0 +1,199 @@
+#version 430 core
+
+precision highp float;
+
+// Compiled per FractalVariant: JULIA iterates the pixel as z with c = u_julia_c, PERIODICITY
+// enables the cycle detection and z escapes once |z| reaches BAILOUT. passes.glsl is appended,
+// it runs the passes on the samples below.
+
+// Parameters all precisions share, bound from a uniform buffer
+layout(std140, binding = 0) uniform FractalParameters {
+	ivec2 u_resolution;
+	float u_zoom;
+	int u_MAX_ITERATIONS;
+	vec2 u_julia_c;
+	// Brent cycle detection, 0 disables it
+	float u_periodTolerance;
+};
+
+// The center split into float pairs, center = hi + lo
+uniform vec2 u_centerHi;
+uniform vec2 u_centerLo;
+
+// z of each pixel center where its iteration stopped, packed by packState. Raising
+// u_MAX_ITERATIONS then continues the centers that reached the old limit instead of starting over.
+layout(std430, binding = 4) buffer IterationStates {
+	uvec4 states[];
+};
+// While continuing the centers, the u_MAX_ITERATIONS they were computed with, 0 otherwise
+uniform int u_resumeFrom;
+
+// Double-single numbers are unevaluated sums hi + lo stored as vec2(hi, lo), giving about
+// 48 bits of mantissa. The error-free transforms below rely on exact rounding, which
+// precise keeps the compiler from reassociating away.
+
+vec2 dsTwoSum(float a, float b) {
+	precise float s = a + b;
+	precise float v = s - a;
+	precise float e = (a - (s - v)) + (b - v);
+	return vec2(s, e);
+}
+
+vec2 dsQuickTwoSum(float a, float b) {
+	precise float s = a + b;
+	precise float e = b - (s - a);
+	return vec2(s, e);
+}
+
+// Veltkamp split into two 12 bit halves whose products are exact, fma isn't relied on
+// since some drivers lower it to a separately rounded multiply and add
+vec2 dsSplit(float a) {
+	precise float t = 4097.0 * a;
+	precise float hi = t - (t - a);
+	precise float lo = a - hi;
+	return vec2(hi, lo);
+}
+
+vec2 dsTwoProd(float a, float b) {
+	precise float p = a * b;
+	vec2 as = dsSplit(a);
+	vec2 bs = dsSplit(b);
+	precise float e = ((as.x * bs.x - p) + as.x * bs.y + as.y * bs.x) + as.y * bs.y;
+	return vec2(p, e);
+}
+
+vec2 dsAdd(vec2 a, vec2 b) {
+	vec2 s = dsTwoSum(a.x, b.x);
+	precise float e = s.y + (a.y + b.y);
+	return dsQuickTwoSum(s.x, e);
+}
+
+vec2 dsSub(vec2 a, vec2 b) {
+	return dsAdd(a, -b);
+}
+
+vec2 dsMul(vec2 a, vec2 b) {
+	vec2 p = dsTwoProd(a.x, b.x);
+	precise float e = p.y + (a.x * b.y + a.y * b.x);
+	return dsQuickTwoSum(p.x, e);
+}
+
+vec2 dsFromFloat(float a) {
+	return vec2(a, 0.0);
+}
+
+// Complex double-single numbers are vec4(re.hi, re.lo, im.hi, im.lo)
+vec4 compAdd(vec4 z1, vec4 z2) {
+	return vec4(dsAdd(z1.xy, z2.xy), dsAdd(z1.zw, z2.zw));
+}
+
+vec4 compMul(vec4 z1, vec4 z2) {
+	return vec4(dsSub(dsMul(z1.xy, z2.xy), dsMul(z1.zw, z2.zw)), dsAdd(dsMul(z1.xy, z2.zw), dsMul(z1.zw, z2.xy)));
+}
+
+// Closed form membership of the main cardioid and the period-2 bulb, whose points never escape.
+// Returns the period of the component c is in, 1 or 2, or 0 if it's in neither.
+// Evaluated in double-single so points just outside the boundary aren't rejected.
+int mainComponentPeriod(vec4 c) {
+	vec2 x = dsAdd(c.xy, dsFromFloat(-0.25));
+	vec2 y2 = dsMul(c.zw, c.zw);
+	vec2 q = dsAdd(dsMul(x, x), y2);
+	vec2 cardioid = dsSub(dsMul(q, dsAdd(q, x)), dsMul(dsFromFloat(0.25), y2));
+	if (cardioid.x < 0.0) return 1;
+	vec2 xb = dsAdd(c.xy, dsFromFloat(1.0));
+	vec2 bulb = dsSub(dsAdd(dsMul(xb, xb), y2), dsFromFloat(0.0625));
+	return bulb.x < 0.0 ? 2 : 0;
+}
+
+// The point the sample at uv iterates and where its z starts
+void samplePoint(vec2 uv, out vec4 c, out vec4 z) {
+	float aspectRatio = float(u_resolution.x) / float(u_resolution.y);
+	// The offset from the center is small, so float is enough for it before the ds addition
+	vec2 offset = uv * vec2(4.0 * aspectRatio, 4.0) / u_zoom;
+	vec4 center = vec4(u_centerHi.x, u_centerLo.x, u_centerHi.y, u_centerLo.y);
+	vec4 pixel = compAdd(center, vec4(dsFromFloat(offset.x), dsFromFloat(offset.y)));
+#ifdef JULIA
+	c = vec4(dsFromFloat(u_julia_c.x), dsFromFloat(u_julia_c.y));
+	z = pixel;
+#else
+	c = pixel;
+	z = vec4(0.0);
+#endif
+}
+
+// Iterates z from iteration iter on until it escapes or reaches u_MAX_ITERATIONS, z is left where it stopped
+vec4 escape(vec4 c, inout vec4 z, int iter, int period) {
+#ifdef PERIODICITY
+	// z is saved after 1, 2, 4, 8... iterations, an orbit coming back to it is in a cycle and never escapes.
+	// The difference is taken in double-single, its high half is accurate enough to compare.
+	vec4 saved = z;
+	int savedAt = iter;
+	int nextSave = max(iter * 2, 1);
+	float tolerance2 = u_periodTolerance * u_periodTolerance;
+#endif
+	while (z.x * z.x + z.z * z.z < BAILOUT * BAILOUT && iter < u_MAX_ITERATIONS) {
+		z = compMul(z, z);
+		z = compAdd(z, c);
+		iter++;
+#ifdef PERIODICITY
+		vec2 d = vec2(dsSub(z.xy, saved.xy).x, dsSub(z.zw, saved.zw).x);
+		if (dot(d, d) < tolerance2) {
+			period = iter - savedAt;
+			iter = u_MAX_ITERATIONS;
+			break;
+		}
+		if (iter == nextSave) {
+			saved = z;
+			savedAt = iter;
+			nextSave *= 2;
+		}
+#endif
+	}
+	float magnitude = length(vec2(z.x, z.z));
+	// Continuous iteration count, the fractional part comes from how far past the bailout z got
+	float smoothIter = iter < u_MAX_ITERATIONS ? float(iter) + 1.0 - log2(log(magnitude)) : float(iter);
+	return vec4(float(iter), smoothIter, magnitude, float(period));
+}
+
+vec4 computeSample(vec2 uv, out vec4 z) {
+	vec4 c;
+	samplePoint(uv, c, z);
+	int iter = 0;
+	int period = 0;
+#ifndef JULIA
+	period = mainComponentPeriod(c);
+	if (period != 0) iter = u_MAX_ITERATIONS;
+#endif
+	return escape(c, z, iter, period);
+}
+
+vec4 computeSample(vec2 uv) {
+	vec4 z;
+	return computeSample(uv, z);
+}
+
+uvec4 packState(vec4 z) {
+	return floatBitsToUint(z);
+}
+
+// Samples the center of pixel index, keeping its state
+vec4 computeCenter(vec2 uv, int index) {
+	vec4 z;
+	vec4 s = computeSample(uv, z);
+	states[index] = packState(z);
+	return s;
+}
+
+// Continues the center whose sample at u_resumeFrom iterations was previous. Centers that escaped
+// stay as they are, those known to be inside, having a period, only move to the new limit.
+vec4 resumeCenter(vec2 uv, int index, vec4 previous) {
+	if (previous.x < float(u_resumeFrom)) return previous;
+	if (previous.w != 0.0) return vec4(vec2(float(u_MAX_ITERATIONS)), previous.zw);
+	vec4 c;
+	vec4 z;
+	samplePoint(uv, c, z);
+	z = uintBitsToFloat(states[index]);
+	vec4 s = escape(c, z, u_resumeFrom, 0);
+	states[index] = packState(z);
+	return s;
+}
\ No newline at end of file
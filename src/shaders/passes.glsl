@@ -0,0 +1,107 @@
+// Appended to one of the fractal shaders, which supply computeSample, computeCenter and
+// resumeCenter in their precision. These are the progressive passes they all share: MAX_GRID is
+// the grid of the edges a 2x2 grid doesn't settle, COMPUTE leaves out the fragment stage's
+// inputs, outputs and main, escape.comp is appended after this and supplies its own.
+
+#ifndef MAX_GRID
+#define MAX_GRID 4
+#endif
+
+#ifdef COMPUTE
+// Pixel center in clip space, set for each invocation by escape.comp
+vec2 position;
+#else
+in vec2 position;
+#endif
+
+// Progressive passes compute the centers of u_step sized blocks, skipping those of the previous
+// u_prevStep pass. u_step 0 is the anti-aliasing pass, which only supersamples the edges.
+// u_step -1 takes one sample per pixel at u_jitter, in pixels, for temporal accumulation.
+uniform int u_step;
+uniform int u_prevStep;
+uniform vec2 u_jitter;
+// Centers from the block passes, read by the anti-aliasing pass and when continuing them
+uniform sampler2D u_centers;
+// Neighbouring centers this many iterations apart make an edge
+uniform float u_edgeThreshold;
+
+// Supersampled pixels take a range of this pool, samples are vec2(iterations + period, smooth iterations)
+layout(std430, binding = 2) buffer SamplePool {
+	uint poolUsed;
+	uint poolCapacity;
+	vec2 poolSamples[];
+};
+
+#ifndef COMPUTE
+// Escape data of the pixel center, colored later by color.frag: vec4(iterations, smooth iterations, |z|, period)
+layout(location = 0) out vec4 center;
+// Offset and count of the pixel's samples in the pool, a count of 0 leaves it at its center
+layout(location = 1) out ivec2 sampleRange;
+#endif
+
+// Whether both samples fall in the same color band, interior samples also need the same period
+bool sameBand(vec4 a, vec4 b) {
+	bool aInside = a.x >= float(u_MAX_ITERATIONS);
+	bool bInside = b.x >= float(u_MAX_ITERATIONS);
+	if (aInside || bInside) return aInside == bInside && a.w == b.w;
+	return abs(a.x - b.x) < u_edgeThreshold;
+}
+
+bool isEdge(ivec2 pixel, vec4 c) {
+	ivec2 last = u_resolution - 1;
+	return !sameBand(c, texelFetch(u_centers, min(pixel + ivec2(1, 0), last), 0))
+		|| !sameBand(c, texelFetch(u_centers, max(pixel - ivec2(1, 0), ivec2(0)), 0))
+		|| !sameBand(c, texelFetch(u_centers, min(pixel + ivec2(0, 1), last), 0))
+		|| !sameBand(c, texelFetch(u_centers, max(pixel - ivec2(0, 1), ivec2(0)), 0));
+}
+
+// Center of cell i of the pixel split into grid x grid cells
+vec2 gridPosition(int i, int grid) {
+	vec2 pixelSize = 2.0 / u_resolution;
+	return position + ((vec2(i % grid, i / grid) + 0.5) / float(grid) - 0.5) * pixelSize;
+}
+
+#ifndef COMPUTE
+void main() {
+	ivec2 pixel = ivec2(gl_FragCoord.xy);
+	if (u_step < 0) {
+		center = computeSample(position + u_jitter * 2.0 / u_resolution);
+		return;
+	}
+	if (u_step > 0) {
+		if (any(notEqual(pixel % u_step, ivec2(0)))) discard;
+		if (u_prevStep > 0 && all(equal(pixel % u_prevStep, ivec2(0)))) discard;
+		int index = pixel.y * u_resolution.x + pixel.x;
+		center = u_resumeFrom > 0 ? resumeCenter(position, index, texelFetch(u_centers, pixel, 0)) : computeCenter(position, index);
+		return;
+	}
+
+	// Flat regions keep their single center sample
+	sampleRange = ivec2(0);
+	vec4 c = texelFetch(u_centers, pixel, 0);
+	if (!isEdge(pixel, c)) return;
+
+	// A 2x2 grid first, edges it doesn't cross are done with the center
+	vec4 corners[4];
+	bool settled = true;
+	for (int i = 0; i < 4; i++) {
+		corners[i] = computeSample(gridPosition(i, 2));
+		settled = settled && sameBand(corners[i], c);
+	}
+	if (settled) return;
+
+	const int count = MAX_GRID * MAX_GRID;
+	uint offset = atomicAdd(poolUsed, uint(count));
+	// Edges past a full pool keep their center
+	if (offset + uint(count) > poolCapacity) return;
+	for (int i = 0; i < count; i++) {
+#if MAX_GRID == 2
+		vec4 s = corners[i];
+#else
+		vec4 s = computeSample(gridPosition(i, MAX_GRID));
+#endif
+		poolSamples[offset + uint(i)] = vec2(s.x + s.w, s.y);
+	}
+	sampleRange = ivec2(offset, count);
+}
+#endif
\ No newline at end of file
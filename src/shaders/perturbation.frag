@@ -0,0 +1,178 @@
+#version 430 core
+
+precision highp float;
+
+// Compiled per FractalVariant: JULIA iterates the pixel as z with c = u_julia_c and z escapes
+// once |z| reaches BAILOUT. passes.glsl is appended, it runs the passes on the samples below.
+
+// Parameters all precisions share, bound from a uniform buffer
+layout(std140, binding = 0) uniform FractalParameters {
+	ivec2 u_resolution;
+	float u_zoom;
+	int u_MAX_ITERATIONS;
+	vec2 u_julia_c;
+	// Brent cycle detection, 0 disables it
+	float u_periodTolerance;
+};
+
+// Offsets from the reference are float mantissas times 2^exponent, so they stay normal floats
+// however deep the zoom. The view's offset and size come in units of 2^u_deltaExponent, u_zoom
+// only fits shallower views.
+uniform int u_deltaExponent;
+uniform vec2 u_offset;
+uniform vec2 u_viewSize;
+uniform int u_orbitLength;
+uniform int u_criticalLength;
+
+// Series approximation of the offset after the first u_skipIterations iterations,
+// coefficients are scaled by u_seriesRadius^k. The radius is in units of 2^u_deltaExponent,
+// the coefficients, and so the offset they give, in units of 2^u_seriesExponent.
+const int MAX_SERIES_TERMS = 16;
+uniform int u_skipIterations;
+uniform int u_seriesTerms;
+uniform int u_seriesExponent;
+uniform float u_seriesRadius;
+uniform vec2 u_series[MAX_SERIES_TERMS];
+
+// Reference orbit computed in high precision on the CPU, pixels iterate their offset from it.
+// The critical orbit starts at z = 0 and is what pixels rebase onto, for Mandelbrot both are the same.
+layout(std430, binding = 0) readonly buffer ReferenceOrbit {
+	vec2 orbit[];
+};
+layout(std430, binding = 1) readonly buffer CriticalOrbit {
+	vec2 critical[];
+};
+
+// Where the iteration of each pixel center stopped, packed by packState. Raising u_MAX_ITERATIONS
+// then continues the centers that reached the old limit instead of starting over.
+layout(std430, binding = 4) buffer IterationStates {
+	uvec4 states[];
+};
+// While continuing the centers, the u_MAX_ITERATIONS they were computed with, 0 otherwise
+uniform int u_resumeFrom;
+
+vec2 compMul(vec2 z1, vec2 z2) {
+	return vec2((z1.x * z2.x) - (z1.y * z2.y), (z1.x * z2.y) + (z1.y * z2.x));
+}
+
+vec2 seriesOffset(vec2 delta) {
+	vec2 u = delta / u_seriesRadius;
+	vec2 sum = vec2(0.0);
+	for (int k = u_seriesTerms - 1; k >= 0; k--) {
+		sum = compMul(sum + u_series[k], u);
+	}
+	return sum;
+}
+
+// v * 2^exponent, flushed to 0 below float's normal range where ldexp is undefined
+vec2 scaled(vec2 v, int exponent) {
+	return exponent < -126 ? vec2(0.0) : ldexp(v, ivec2(exponent));
+}
+
+// delta' = 2 * Z * delta + delta^2 + deltaC, rebasing onto the critical orbit when the
+// pixel gets closer to 0 than to the reference or the reference runs out. delta is
+// dz * 2^exponent and deltaC dc * 2^u_deltaExponent. Iterates from iteration iter at index m
+// of the reference, or of the critical orbit once onCritical, and leaves dz, exponent, m and
+// onCritical where it stopped.
+int perturbedIterations(inout vec2 dz, inout int exponent, vec2 dc, int iter, inout int m, inout bool onCritical, out vec2 z) {
+	int orbitLength = onCritical ? u_criticalLength : u_orbitLength;
+	z = vec2(0.0);
+	while (iter < u_MAX_ITERATIONS) {
+		vec2 Z = onCritical ? critical[m] : orbit[m];
+		// Flushes to 0 while it's too small to matter next to Z
+		vec2 delta = scaled(dz, exponent);
+		z = Z + delta;
+		float magnitude = dot(z, z);
+		if (magnitude >= BAILOUT * BAILOUT) break;
+		if (magnitude < dot(delta, delta) || m == orbitLength - 1) {
+			onCritical = true;
+			orbitLength = u_criticalLength;
+			m = 0;
+			Z = critical[0];
+			dz = z - Z;
+			exponent = 0;
+			delta = dz;
+		}
+		dz = 2.0 * compMul(Z, dz) + compMul(delta, dz) + scaled(dc, u_deltaExponent - exponent);
+		// Growing offsets move their magnitude into the exponent until it's back at 0
+		if (exponent < 0 && max(abs(dz.x), abs(dz.y)) > 4294967296.0) {
+			int shift = min(32, -exponent);
+			dz = ldexp(dz, ivec2(-shift));
+			exponent += shift;
+		}
+		m++;
+		iter++;
+	}
+	return iter;
+}
+
+// Offset of the point at uv from the reference, in units of 2^u_deltaExponent
+vec2 sampleDelta(vec2 uv) {
+	return u_offset + uv * u_viewSize;
+}
+
+vec4 escapeData(int iter, vec2 z) {
+	float magnitude = length(z);
+	// Continuous iteration count, the fractional part comes from how far past the bailout z got
+	float smoothIter = iter < u_MAX_ITERATIONS ? float(iter) + 1.0 - log2(log(magnitude)) : float(iter);
+	return vec4(float(iter), smoothIter, magnitude, 0.0);
+}
+
+uvec4 packState(vec2 dz, int exponent, int m, bool onCritical) {
+	return uvec4(floatBitsToUint(dz), uint(m), uint(onCritical) | uint(-exponent) << 1);
+}
+
+vec4 computeSample(vec2 uv, out uvec4 state) {
+	vec2 delta = sampleDelta(uv);
+#ifdef JULIA
+	vec2 dz = delta;
+	vec2 dc = vec2(0.0);
+#else
+	vec2 dz = vec2(0.0);
+	vec2 dc = delta;
+#endif
+	int exponent = u_deltaExponent;
+	if (u_skipIterations > 0) {
+		dz = seriesOffset(delta);
+		exponent = u_seriesExponent;
+	}
+	int m = u_skipIterations;
+	bool onCritical = false;
+	vec2 z;
+	int iter = perturbedIterations(dz, exponent, dc, u_skipIterations, m, onCritical, z);
+	state = packState(dz, exponent, m, onCritical);
+	return escapeData(iter, z);
+}
+
+vec4 computeSample(vec2 uv) {
+	uvec4 state;
+	return computeSample(uv, state);
+}
+
+// Samples the center of pixel index, keeping its state
+vec4 computeCenter(vec2 uv, int index) {
+	uvec4 state;
+	vec4 s = computeSample(uv, state);
+	states[index] = state;
+	return s;
+}
+
+// Continues the center whose sample at u_resumeFrom iterations was previous, from the offset and
+// orbit index it stopped at. The reference must be the same one. Centers that escaped stay as they are.
+vec4 resumeCenter(vec2 uv, int index, vec4 previous) {
+	if (previous.x < float(u_resumeFrom)) return previous;
+#ifdef JULIA
+	vec2 dc = vec2(0.0);
+#else
+	vec2 dc = sampleDelta(uv);
+#endif
+	uvec4 state = states[index];
+	vec2 dz = uintBitsToFloat(state.xy);
+	int exponent = -int(state.w >> 1);
+	int m = int(state.z);
+	bool onCritical = (state.w & 1u) != 0u;
+	vec2 z;
+	int iter = perturbedIterations(dz, exponent, dc, u_resumeFrom, m, onCritical, z);
+	states[index] = packState(dz, exponent, m, onCritical);
+	return escapeData(iter, z);
+}
\ No newline at end of file
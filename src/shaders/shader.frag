@@ -2,18 +2,29 @@
 
 precision highp float;
 
-in vec2 position;
+// Compiled per FractalVariant: JULIA iterates the pixel as z with c = u_julia_c, PERIODICITY
+// enables the cycle detection and z escapes once |z| reaches BAILOUT. passes.glsl is appended,
+// it runs the passes on the samples below.
+
+// Parameters all precisions share, bound from a uniform buffer
+layout(std140, binding = 0) uniform FractalParameters {
+	ivec2 u_resolution;
+	float u_zoom;
+	int u_MAX_ITERATIONS;
+	vec2 u_julia_c;
+	// Brent cycle detection, 0 disables it
+	float u_periodTolerance;
+};
 
-uniform ivec2 u_resolution;
 uniform vec2 u_center;
-uniform float u_zoom;
-uniform int u_MAX_ITERATIONS;
-uniform int u_BASE_ITERATIONS;
-uniform float u_saturation;
-uniform float u_brightness;
-uniform vec2 u_julia_c;
 
-out vec4 screenColor;
+// z of each pixel center where its iteration stopped, packed by packState. Raising
+// u_MAX_ITERATIONS then continues the centers that reached the old limit instead of starting over.
+layout(std430, binding = 4) buffer IterationStates {
+	uvec4 states[];
+};
+// While continuing the centers, the u_MAX_ITERATIONS they were computed with, 0 otherwise
+uniform int u_resumeFrom;
 
 vec2 compAdd(vec2 z1, vec2 z2) {
 	return z1 + z2;
@@ -27,72 +38,100 @@ float map(float x, float inMin, float inMax, float outMin, float outMax) {
 	return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
 }
 
-vec3 hsvToRgb(float h, float s, float v) {
-    float p = v * (1.0 - s);
-    float q = v * (1.0 - s * fract(h * 6.0));
-    float t = v * (1.0 - s * (1.0 - fract(h * 6.0)));
-
-    if (h < 1.0/6.0) return vec3(v, t, p);
-    if (h < 2.0/6.0) return vec3(q, v, p);
-    if (h < 3.0/6.0) return vec3(p, v, t);
-    if (h < 4.0/6.0) return vec3(p, q, v);
-    if (h < 5.0/6.0) return vec3(t, p, v);
-    return vec3(v, p, q);
+// Closed form membership of the main cardioid and the period-2 bulb, whose points never escape.
+// Returns the period of the component c is in, 1 or 2, or 0 if it's in neither.
+int mainComponentPeriod(vec2 c) {
+	float x = c.x - 0.25;
+	float y2 = c.y * c.y;
+	float q = x * x + y2;
+	if (q * (q + x) < 0.25 * y2) return 1;
+	return (c.x + 1.0) * (c.x + 1.0) + y2 < 0.0625 ? 2 : 0;
 }
 
-vec3 computeFragColor(vec2 uv) {
-	vec3 color;
+// The point the sample at uv iterates and where its z starts
+void samplePoint(vec2 uv, out vec2 c, out vec2 z) {
 	float aspectRatio = float(u_resolution.x) / float(u_resolution.y);
-	vec2 c;
-	vec2 z;
-	if (!isnan(u_julia_c.x) && !isnan(u_julia_c.y)) {
-		c = u_julia_c;
-		z = u_center + (uv) * vec2(4.0 * aspectRatio, 4.0) / u_zoom;
-	} else {
-		c = u_center + (uv) * vec2(4.0 * aspectRatio, 4.0) / u_zoom;
-		z = vec2(0.0);
-	}
-	int iter = 0;
-	while (length(z) < 2.0 && iter < u_MAX_ITERATIONS) {
+#ifdef JULIA
+	c = u_julia_c;
+	z = u_center + (uv) * vec2(4.0 * aspectRatio, 4.0) / u_zoom;
+#else
+	c = u_center + (uv) * vec2(4.0 * aspectRatio, 4.0) / u_zoom;
+	z = vec2(0.0);
+#endif
+}
+
+// Iterates z from iteration iter on until it escapes or reaches u_MAX_ITERATIONS, z is left where it stopped
+vec4 escape(vec2 c, inout vec2 z, int iter, int period) {
+#ifdef PERIODICITY
+	// z is saved after 1, 2, 4, 8... iterations, an orbit coming back to it is in a cycle and never escapes
+	vec2 saved = z;
+	int savedAt = iter;
+	int nextSave = max(iter * 2, 1);
+	float tolerance2 = u_periodTolerance * u_periodTolerance;
+#endif
+	while (length(z) < BAILOUT && iter < u_MAX_ITERATIONS) {
 		z = compMul(z,z);
 		z = compAdd(z,c);
 		iter++;
+#ifdef PERIODICITY
+		vec2 d = z - saved;
+		if (dot(d, d) < tolerance2) {
+			period = iter - savedAt;
+			iter = u_MAX_ITERATIONS;
+			break;
+		}
+		if (iter == nextSave) {
+			saved = z;
+			savedAt = iter;
+			nextSave *= 2;
+		}
+#endif
 	}
-	if (iter == u_MAX_ITERATIONS) {
-		color = vec3(0.0);
-	} else {
-        float t = float(iter) / float(u_BASE_ITERATIONS);
-		float hue = mod(t * 5.0, 1.0);
-        color = hsvToRgb(hue, u_saturation, u_brightness);
-	}
-	return color;
+	float magnitude = length(z);
+	// Continuous iteration count, the fractional part comes from how far past the bailout z got
+	float smoothIter = iter < u_MAX_ITERATIONS ? float(iter) + 1.0 - log2(log(magnitude)) : float(iter);
+	return vec4(float(iter), smoothIter, magnitude, float(period));
 }
 
-void main() {
-	/*if (abs(position.x) + abs(position.y) < 0.25)
-	{
-		screenColor = vec4(1.0, 0.0, 0.0, 1.0);
-		return;
-	}*/
-
-	vec3 color = vec3(0.0);
-
-	// between 1.5 and 2.0 seems to be a good constant
-	vec2 pixelSize = 2.0 / u_resolution;
-	const int numSamples = 4;
-	vec2 offsets[numSamples] = vec2[](
-    	vec2(-0.25, -0.25) * pixelSize,
-    	vec2( 0.25, -0.25) * pixelSize,
-    	vec2(-0.25,  0.25) * pixelSize,
-    	vec2( 0.25,  0.25) * pixelSize
-	);
-
-	// Quincunx sample pattern for anti-aliasing
-	for (int i = 0; i < numSamples; i++) {
-		vec2 uvSample = position + offsets[i];
-		color += computeFragColor(uvSample) * 0.125;
-	}
-	color += computeFragColor(position) * 0.5;
+vec4 computeSample(vec2 uv, out vec2 z) {
+	vec2 c;
+	samplePoint(uv, c, z);
+	int iter = 0;
+	int period = 0;
+#ifndef JULIA
+	period = mainComponentPeriod(c);
+	if (period != 0) iter = u_MAX_ITERATIONS;
+#endif
+	return escape(c, z, iter, period);
+}
+
+vec4 computeSample(vec2 uv) {
+	vec2 z;
+	return computeSample(uv, z);
+}
+
+uvec4 packState(vec2 z) {
+	return uvec4(floatBitsToUint(z), 0u, 0u);
+}
 
-	screenColor = vec4(color, 1.0);
+// Samples the center of pixel index, keeping its state
+vec4 computeCenter(vec2 uv, int index) {
+	vec2 z;
+	vec4 s = computeSample(uv, z);
+	states[index] = packState(z);
+	return s;
+}
+
+// Continues the center whose sample at u_resumeFrom iterations was previous. Centers that escaped
+// stay as they are, those known to be inside, having a period, only move to the new limit.
+vec4 resumeCenter(vec2 uv, int index, vec4 previous) {
+	if (previous.x < float(u_resumeFrom)) return previous;
+	if (previous.w != 0.0) return vec4(vec2(float(u_MAX_ITERATIONS)), previous.zw);
+	vec2 c;
+	vec2 z;
+	samplePoint(uv, c, z);
+	z = uintBitsToFloat(states[index].xy);
+	vec4 s = escape(c, z, u_resumeFrom, 0);
+	states[index] = packState(z);
+	return s;
 }
\ No newline at end of file
@@ -0,0 +1,42 @@
+# Renders SCENE headless with every SIMD kernel, with and without --subdivide, and fails unless
+# each image matches the plain scalar render byte for byte. Kernels the CPU lacks are skipped.
+# Usage: cmake -DFRACTALDIVE=<exe> -DNAME=<name> -DSCENE=<headless options> -DOUTPUT_DIR=<dir> -P CompareKernels.cmake
+
+separate_arguments(SCENE UNIX_COMMAND "${SCENE}")
+file(MAKE_DIRECTORY "${OUTPUT_DIR}")
+
+set(REFERENCE "${OUTPUT_DIR}/${NAME}_scalar.ppm")
+execute_process(COMMAND "${FRACTALDIVE}" --headless ${SCENE} --isa scalar --output "${REFERENCE}"
+	RESULT_VARIABLE RESULT OUTPUT_QUIET)
+if(NOT RESULT EQUAL 0)
+	message(FATAL_ERROR "Scalar render of ${NAME} failed")
+endif()
+
+set(DIFFERENT "")
+foreach(ISA scalar sse2 avx2 avx512)
+	foreach(SUBDIVIDE "" "--subdivide")
+		if(ISA STREQUAL "scalar" AND SUBDIVIDE STREQUAL "")
+			continue()
+		endif()
+		set(IMAGE "${OUTPUT_DIR}/${NAME}_${ISA}${SUBDIVIDE}.ppm")
+		execute_process(COMMAND "${FRACTALDIVE}" --headless ${SCENE} --isa ${ISA} ${SUBDIVIDE} --output "${IMAGE}"
+			RESULT_VARIABLE RESULT OUTPUT_VARIABLE LOG)
+		if(LOG MATCHES "is not supported on this CPU")
+			message(STATUS "${ISA} skipped, not supported on this CPU")
+			break()
+		endif()
+		if(NOT RESULT EQUAL 0)
+			message(FATAL_ERROR "${ISA} ${SUBDIVIDE} render of ${NAME} failed")
+		endif()
+		execute_process(COMMAND "${CMAKE_COMMAND}" -E compare_files "${REFERENCE}" "${IMAGE}" RESULT_VARIABLE RESULT)
+		if(NOT RESULT EQUAL 0)
+			string(STRIP "${ISA} ${SUBDIVIDE}" RUN)
+			list(APPEND DIFFERENT "${RUN}")
+		endif()
+	endforeach()
+endforeach()
+
+if(DIFFERENT)
+	string(REPLACE ";" ", " DIFFERENT "${DIFFERENT}")
+	message(FATAL_ERROR "${NAME} differs from the scalar render with: ${DIFFERENT}")
+endif()
@@ -0,0 +1,71 @@
+#include <IterationLimit.h>
+
+#include <iostream>
+#include <limits>
+#include <vector>
+
+// A view is the escape time of each of its samples, infinity for the interior
+static std::vector<float> renderCenters(const std::vector<float>& escapeTimes, int maxIterations)
+{
+	std::vector<float> centers;
+	for (float time : escapeTimes)
+	{
+		float iterations = time < maxIterations ? time : static_cast<float>(maxIterations);
+		// Periods stay 0 like with perturbation or periodicity off
+		centers.insert(centers.end(), {iterations, iterations, 2.0f, 0.0f});
+	}
+	return centers;
+}
+
+// Runs the automatic limit over frames of a still view, returns the limit of the last frame
+// or 0 if it still changed during the last few
+static int settle(const std::vector<float>& escapeTimes, int limit)
+{
+	EscapeStatistics raisedFrom;
+	int changedAt = 0;
+	const int frames = 64;
+	for (int frame = 0; frame < frames; frame++)
+	{
+		EscapeStatistics statistics = gatherEscapeStatistics(renderCenters(escapeTimes, limit), limit);
+		int next = chooseIterationLimit(statistics, raisedFrom);
+		raisedFrom = next > limit ? statistics : EscapeStatistics();
+		if (next != limit) changedAt = frame;
+		limit = next;
+	}
+	return changedAt < frames - 8 ? limit : 0;
+}
+
+static bool check(bool condition, const char* name)
+{
+	std::cout << (condition ? "ok   " : "FAIL ") << name << std::endl;
+	return condition;
+}
+
+int main()
+{
+	const float interior = std::numeric_limits<float>::infinity();
+	bool passed = true;
+
+	std::vector<float> allInterior(4096, interior);
+	passed &= check(settle(allInterior, 256) == 256, "all interior view keeps its limit");
+	passed &= check(settle(allInterior, 100000) == 100000, "all interior view at a high limit keeps it");
+
+	// Half interior, the rest escapes after up to about 100000 iterations
+	std::vector<float> boundary(4096, interior);
+	for (int i = 0; i < 2048; i++)
+	{
+		boundary[i] = 20.0f + i * i / 42.0f;
+	}
+	int boundaryLimit = settle(boundary, 256);
+	passed &= check(boundaryLimit > 100000 && boundaryLimit < 1000000, "boundary view raises until its escapes fit, then settles");
+
+	// Escapes that end far below the limit bring it down
+	std::vector<float> shallow(4096, interior);
+	for (int i = 0; i < 2048; i++)
+	{
+		shallow[i] = 10.0f + i % 90;
+	}
+	passed &= check(settle(shallow, 8192) == 256, "shallow view lowers its limit");
+
+	return passed ? 0 : 1;
+}